@@ -19,10 +19,10 @@ bool ai_play (board_t *board, history_t *history) {
 
 
 static minimax_ab_ai_t get_minimax_ai (const player_t ai) {
-	const minimax_ab_ai_t	MINIMAX_AB_LVL0 = { 1, piece_value_based_static_eval },
-							MINIMAX_AB_LVL1 = { 2, piece_value_based_static_eval },
-							MINIMAX_AB_LVL2 = { 3, piece_value_based_static_eval },
-							MINIMAX_AB_LVL3 = { 4, piece_value_based_static_eval };
+	const minimax_ab_ai_t	MINIMAX_AB_LVL0 = { 1, piece_value_based_static_eval, ALL_PRUNING },
+							MINIMAX_AB_LVL1 = { 2, piece_value_based_static_eval, ALL_PRUNING },
+							MINIMAX_AB_LVL2 = { 3, piece_value_based_static_eval, ALL_PRUNING },
+							MINIMAX_AB_LVL3 = { 4, piece_value_based_static_eval, ALL_PRUNING };
 
 	switch (ai.type) {
 		case AI_LVL0:
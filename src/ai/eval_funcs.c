@@ -10,16 +10,8 @@ board_value_t piece_value_based_static_eval (const board_t *board) {
 		return 0;
 
 	board_value_t board_value = 0;
-	for (int i = 0; i < 8; i++) {
-		for (int j = 0; j < 8; j++) {
-			piece_t *piece = board->tiles[i][j].piece;
-			if (piece == NULL)
-				continue;
-			int type = 0;
-			while (!(piece->face & (1 << type))) type++;
-			board_value += (piece->face & BLACK ? -1: 1) * piece_values[type];
-		}
-	}
+	for (int type = 0; type < PIECE_TYPES; type++)
+		board_value += piece_values[type] * (bb_popcount(board->pieces[0][type]) - bb_popcount(board->pieces[1][type]));
 
 	return board_value;
 }
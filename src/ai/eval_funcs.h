@@ -7,6 +7,8 @@
 
 #define	MIN_BOARD_VALUE	INT_MIN
 #define MAX_BOARD_VALUE	INT_MAX
+#define DRAW_BOARD_VALUE	0
+#define MATE_BOARD_VALUE	1000000	// of mating right away, search takes a ply off it for each ply the mate is away
 
 
 typedef	int	board_value_t;
@@ -1,22 +1,117 @@
-#include <limits.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
 #include <unistd.h>
+#include <pthread.h>
+#include <stdatomic.h>
 
 #include "minimax_ab.h"
 #include "../core/chess_engine.h"
-#include "../utils/common.h"	// min, max and shuffle
+#include "../core/draw.h"
+#include "tt.h"
+#include "move_order.h"
+#include "see.h"
+#include "../utils/common.h"	// min and max
+
+#define	EXPECTED_GAME_MOVES	40		// moves a game is expected to last when sharing the clock between moves
+#define	MIN_MOVES_TO_GO		15
+#define	MAX_MOVE_SHARES		4		// hard limit lets a move take this many even shares of the clock
+#define	TIME_CHECK_NODES	1023	// clock is read once in this many nodes (plus one)
+#define	DELTA_MARGIN		2		// captures in quiescence that can't bring the value this close to the window are skipped
+#define	ASPIRATION_WINDOW	1		// root window around last iteration's value, widened on failing
+#define	MAX_ASPIRATION		8		// window is dropped once widened past it
+#define	INFINITE_VALUE		MAX_BOARD_VALUE	// bound of the full window, unlike MIN_BOARD_VALUE it can be negated
+#define	NULL_MOVE_DEPTH		3		// least depth for null move pruning
+#define	NULL_VERIFY_DEPTH	8		// from this depth a null move cutoff is verified by a reduced search, against zugzwangs pieces don't guard
+#define	null_move_reduction(depth)	(2 + (depth) / 4)
+#define	LMR_DEPTH			3		// least depth for late move reductions
+#define	LMR_MOVES			3		// moves searched at full depth before reducing
+#define	GOOD_HISTORY		(MAX_HISTORY / 16)	// quiet moves with at least this history score are reduced less
+#define	FUTILITY_DEPTH		2		// futility pruning and razoring are done this close to leaves
+#define	futility_margin(depth)	(2 * (depth))	// most a quiet move with short search after it is expected to gain, in pawns
+#define	razor_margin(depth)		(3 * (depth))
+
+/* static eval is from white's point of view, search values are from side to move's */
+#define	relative_eval(search, board)	((board)->chance == WHITE ? (*(search)->eval_func)(board): -(*(search)->eval_func)(board))
+#define	is_mate_value(value)			(abs(value) >= MATE_BOARD_VALUE - MAX_SEARCH_PLIES && abs(value) <= MATE_BOARD_VALUE)
 
 
 typedef struct {
 	board_value_t	board_value;
-	short			src_tile[2];
-	short			dest_tile[2];
-} move_t;
+	move_t			move;
+} scored_move_t;
+
+/*
+ * Lazy SMP, all threads search the same position and share what they find only through the transposition table.
+ * This is the part of a search they share, each has its own search_t.
+ */
+typedef struct {
+	minimax_ab_ai_t ai;
+	struct timespec start;
+	_Atomic double soft_limit;	// in secs since start, 0 for no limit. set while searching when pondering goes on
+	_Atomic double hard_limit;
+	atomic_bool is_stopped;		// set at hard limit, by main thread at soft limit and once any thread completed the last depth
+	pthread_mutex_t lock;		// guards best_move and depth
+	scored_move_t best_move;	// of deepest iteration completed by any thread
+	int depth;
+} smp_t;
+
+/* state shared by all nodes searched by one thread */
+typedef struct {
+	smp_t *smp;
+	int id;						// 0 for main thread
+	board_t board;				// simulated moves are made and unmade on it
+	key_stack_t stack;
+	board_value_t (*eval_func)(const board_t *board);
+	long long nodes;
+	long long cutoffs;
+	long long first_move_cutoffs;
+	long long researches;		// root searches repeated with a wider aspiration window
+	move_order_t order;
+	int pruning;				// mask of enum pruning
+	bool after_null[MAX_SEARCH_PLIES + 1];	// reached by a null move, so no null move is tried at it
+	bool is_verifying[MAX_SEARCH_PLIES + 1];	// reduced search confirming a null move cutoff, its result isn't stored over the node's own
+	move_t root_move;			// best move of last completed iteration, searched first
+	bool is_stopped;			// copy of smp's flag, results of the running iteration are incomplete
+} search_t;
+
+/* one search of a position by all threads, run by the calling thread or in background while pondering */
+typedef struct {
+	smp_t smp;
+	board_t board;				// position searched
+	search_t *searches;			// one for each thread
+	int threads;
+	search_result_t result;		// filled once the job has run
+	pthread_t thread;			// running the job when pondering
+} job_t;
 
+static	int				search_threads	=	1;
+static	job_t			*ponder_job		=	NULL;	// search on opponent's time
+static	search_result_t	last_search;		// for display, written by the game thread and read by display thread
+static	pthread_mutex_t	last_search_lock	=	PTHREAD_MUTEX_INITIALIZER;
 
-static	move_t	_minimax_ab	(board_t *board, history_t *history, board_value_t alpha, board_value_t beta, int depth, board_value_t (*eval_func)(const board_t *board));
+
+static	job_t*			create_job			(const board_t *board, const history_t *history, const minimax_ab_ai_t minimax_ab_ai);
+static	void			set_time_budget		(job_t *job, const board_t *board, const history_t *history);
+static	void			run_job				(job_t *job);
+static	void			delete_job			(job_t *job);
+static	void			start_pondering		(const board_t *board, const history_t *history, const minimax_ab_ai_t minimax_ab_ai);
+static	bool			finish_pondering	(const board_t *board, const history_t *history, search_result_t *result);
+static	void*			ponder_thread		(void *arg);
+static	void			init_search			(search_t *search, smp_t *smp, int id, const board_t *board, const history_t *history);
+static	void*			search_thread		(void *arg);
+static	void			iterate				(search_t *search);
+static	scored_move_t	search_root			(board_t *board, search_t *search, board_value_t last_value, int depth);
+static	scored_move_t	_minimax_ab			(board_t *board, search_t *search, board_value_t alpha, board_value_t beta, int depth, int ply);
+static	board_value_t	quiescence			(board_t *board, search_t *search, board_value_t alpha, board_value_t beta, int ply);
+static	void			count_node			(search_t *search);
+static	bool			has_pieces			(const board_t *board);
+static	board_value_t	value_to_tt			(board_value_t board_value, int ply);
+static	board_value_t	value_from_tt		(board_value_t board_value, int ply);
+static	int				late_move_reduction	(int depth, int move_count, int score);
+static	void			find_time_budget	(int remaining_secs, int move_number, double *soft_limit, double *hard_limit);
+static	double			elapsed_secs		(const struct timespec *start);
 
 
 bool minimax_ab_play (board_t *board, history_t *history, const minimax_ab_ai_t minimax_ab_ai) {
@@ -24,184 +119,591 @@ bool minimax_ab_play (board_t *board, history_t *history, const minimax_ab_ai_t
 	// initialize random no generator
 	srand((unsigned int) time(&t));
 
-	// work on duplicate board so that it doesn't mess with display and timer threads.
-	board_t *dup_board = (board_t *) malloc(sizeof(board_t));
-	copy_board(dup_board, board);
+	search_result_t result;
+	if (!finish_pondering(board, history, &result))
+		minimax_ab_search(board, history, minimax_ab_ai, &result);
+
+	// sleep some random amount of time to mimic thinking (aviod divide by zero), not on the clock as search already took its share of it
+	if (board->plr_times[board->chance & BLACK ? 1: 0] < 0) {
+		int sleep_time = max(1, rand()%(MAX_AI_DEPTH+1 - minimax_ab_ai.depth) + 1);
+		sleep(sleep_time);
+	}
+
+	if (result.move == NULL_MOVE)
+		return false;
+
+	if (!play_move(board, result.move, history))
+		return false;
+	start_pondering(board, history, minimax_ab_ai);
+	return true;
+}
+
+
+/*
+ * Best move for side to move of board, history may be NULL for positions not reached in a game.
+ * Search deepens one ply at a time up to the ai's depth. With the clock running, no iteration is started after the soft limit
+ * and the running one is abandoned at the hard limit, the move of the deepest completed iteration is played then.
+ */
+move_t minimax_ab_search (const board_t *board, const history_t *history, const minimax_ab_ai_t minimax_ab_ai, search_result_t *result) {
+	job_t *job = create_job(board, history, minimax_ab_ai);
+	set_time_budget(job, board, history);
+	run_job(job);
+	*result = job->result;
+	delete_job(job);
+	return result->move;
+}
+
+
+/* stops and forgets the search on opponent's time, if there is one. called when the game it was started for is left or changed */
+void stop_pondering (void) {
+	if (ponder_job == NULL)
+		return;
+	atomic_store(&ponder_job->smp.is_stopped, true);
+	pthread_join(ponder_job->thread, NULL);
+	delete_job(ponder_job);
+	ponder_job = NULL;
+}
+
+
+/* no. of threads searching together, clamped to 1..MAX_SEARCH_THREADS */
+void set_search_threads (int threads) {
+	search_threads = max(1, min(threads, MAX_SEARCH_THREADS));
+}
+
+
+int get_search_threads (void) {
+	return search_threads;
+}
+
+
+/* result of last search by the AI, false if it hasn't searched yet */
+bool get_last_search (search_result_t *result) {
+	pthread_mutex_lock(&last_search_lock);
+	*result = last_search;
+	pthread_mutex_unlock(&last_search_lock);
+	return (result->threads > 0);
+}
+
+
+/* all threads' searches of board, history may be NULL */
+static job_t* create_job (const board_t *board, const history_t *history, const minimax_ab_ai_t minimax_ab_ai) {
+	job_t *job = (job_t *) malloc(sizeof(job_t));
+	smp_t *smp = &job->smp;
+	smp->ai = minimax_ab_ai;
+	atomic_init(&smp->is_stopped, false);
+	atomic_init(&smp->soft_limit, 0);
+	atomic_init(&smp->hard_limit, 0);
+	pthread_mutex_init(&smp->lock, NULL);
+	smp->best_move.move = NULL_MOVE;
+	smp->depth = 0;
+	clock_gettime(CLOCK_MONOTONIC, &smp->start);
+
+	// work on duplicate boards so that it doesn't mess with display and timer threads.
+	copy_board(&job->board, board);
+	job->threads = search_threads;
+	job->searches = (search_t *) malloc(job->threads * sizeof(search_t));
+	new_tt_search();
+	for (int id = 0; id < job->threads; id++)
+		init_search(&job->searches[id], smp, id, board, history);
+	return job;
+}
+
+
+/* limits of side to move's move, counted from now. can be set while the job runs, that is how pondering goes on once its move is played */
+static void set_time_budget (job_t *job, const board_t *board, const history_t *history) {
+	int remaining_secs = board->plr_times[board->chance & BLACK ? 1: 0];
+	if (remaining_secs < 0)
+		return;
+
+	double soft_limit, hard_limit, elapsed = elapsed_secs(&job->smp.start);
+	find_time_budget(remaining_secs, (history ? get_size(history) / 2 + 1: 1), &soft_limit, &hard_limit);
+	atomic_store(&job->smp.soft_limit, elapsed + soft_limit);
+	atomic_store(&job->smp.hard_limit, elapsed + hard_limit);
+}
+
 
+/* main thread searches in the calling thread, helpers in their own */
+static void run_job (job_t *job) {
+	pthread_t helpers[MAX_SEARCH_THREADS];
+	// a helper that can't be started is left out
+	int started = 1;
+	for (int id = 1; id < job->threads; id++)
+		if (pthread_create(&helpers[started], NULL, search_thread, (void *) &job->searches[id]) == 0)
+			started++;
+
+	iterate(&job->searches[0]);
+	for (int i = 1; i < started; i++)
+		pthread_join(helpers[i], NULL);
+
+	scored_move_t best_move = job->smp.best_move;
+	// out of time before first iteration completed, any legal move is better than losing on time. without legal moves search has found mate or stalemate
+	if (job->smp.depth == 0) {
+		movelist_t list;
+		best_move.board_value = relative_eval(&job->searches[0], &job->board);
+		if (generate_moves(&job->board, &list) > 0)
+			best_move.move = list.moves[0];
+	}
+
+	search_result_t *result = &job->result;
+	result->move = best_move.move;
+	result->board_value = (job->board.chance == WHITE ? best_move.board_value: -best_move.board_value);
+	result->depth = job->smp.depth;
+	result->threads = started;
+	result->nodes = result->cutoffs = result->first_move_cutoffs = result->researches = 0;
+	for (int id = 0; id < job->threads; id++) {
+		result->nodes += job->searches[id].nodes;
+		result->cutoffs += job->searches[id].cutoffs;
+		result->first_move_cutoffs += job->searches[id].first_move_cutoffs;
+		result->researches += job->searches[id].researches;
+	}
+	result->secs = elapsed_secs(&job->smp.start);
+
+	pthread_mutex_lock(&last_search_lock);
+	last_search = *result;
+	pthread_mutex_unlock(&last_search_lock);
+}
+
+
+static void delete_job (job_t *job) {
+	pthread_mutex_destroy(&job->smp.lock);
+	free(job->searches);
+	free(job);
+}
+
+
+/*
+ * After its move, AI searches the position after the reply it expects (best move stored for the position in the tt) in background.
+ * The search stops at the ai's depth, no time limits are set till the reply is played.
+ */
+static void start_pondering (const board_t *board, const history_t *history, const minimax_ab_ai_t minimax_ab_ai) {
+	stop_pondering();
+	tt_entry_t entry;
+	if (board->result != PENDING || !probe_tt(board->key, &entry) || entry.move == NULL_MOVE)
+		return;
+
+	// entry may be of another position with same key
+	movelist_t list;
+	generate_moves(board, &list);
+	int i = 0;
+	while (i < list.count && list.moves[i] != entry.move)
+		i++;
+	if (i == list.count)
+		return;
+
+	board_t expected;
+	copy_board(&expected, board);
+	undo_t undo;
+	make_move(&expected, entry.move, &undo);
+	if (!has_legal_move(&expected))
+		return;
+
+	// history ends with board, the position before expected one
+	ponder_job = create_job(&expected, history, minimax_ab_ai);
+	if (pthread_create(&ponder_job->thread, NULL, ponder_thread, (void *) ponder_job) != 0) {
+		delete_job(ponder_job);
+		ponder_job = NULL;
+	}
+}
+
+
+/*
+ * If the opponent played the expected reply, search on the opponent's time goes on with side to move's time limits and its result is
+ * returned in result. Otherwise it is cancelled and false is returned, what it stored in the tt is still used by the search that follows.
+ */
+static bool finish_pondering (const board_t *board, const history_t *history, search_result_t *result) {
+	if (ponder_job == NULL)
+		return false;
+	if (ponder_job->board.key != board->key) {
+		stop_pondering();
+		return false;
+	}
+
+	set_time_budget(ponder_job, board, history);
+	pthread_join(ponder_job->thread, NULL);
+	*result = ponder_job->result;
+	delete_job(ponder_job);
+	ponder_job = NULL;
+	return true;
+}
+
+
+static void* ponder_thread (void *arg) {
+	run_job((job_t *) arg);
+	flush_tt_stats();
+	return NULL;
+}
+
+
+static void init_search (search_t *search, smp_t *smp, int id, const board_t *board, const history_t *history) {
+	search->smp = smp;
+	search->id = id;
+	copy_board(&search->board, board);
 	// mark as fake so that it doesn't pormpt promote menu when pawn reaches end in simulation
-	dup_board->is_fake = true;
-	// mark as fake to avoid rendering of simulated history
-	set_history_fake(history);
+	search->board.is_fake = true;
 
-	move_t best_move = _minimax_ab(dup_board, history, MIN_BOARD_VALUE, MAX_BOARD_VALUE, minimax_ab_ai.depth, minimax_ab_ai.eval_func);
+	/* history is left untouched and only its keys are copied for repetitions. in a game it ends with board, which search pushes itself */
+	init_key_stack(&search->stack, history);
+	if (search->stack.count > 0 && search->stack.keys[search->stack.count - 1] == board->key)
+		pop_key(&search->stack);
+	search->eval_func = smp->ai.eval_func;
+	search->nodes = 0;
+	search->cutoffs = search->first_move_cutoffs = search->researches = 0;
+	clear_move_order(&search->order);
+	search->pruning = smp->ai.pruning;
+	memset(search->after_null, 0, sizeof(search->after_null));
+	memset(search->is_verifying, 0, sizeof(search->is_verifying));
+	search->root_move = NULL_MOVE;
+	search->is_stopped = false;
+}
 
-	// unset history fake so that it can be rendered
-	unset_history_fake(history);
 
-	// sleep some random amount of time to mimic thinking (aviod divide by zero)
-	int sleep_time = max(1, rand()%(MAX_AI_DEPTH+1 - minimax_ab_ai.depth) + 1);
-	sleep(sleep_time);
+static void* search_thread (void *arg) {
+	iterate((search_t *) arg);
+	flush_tt_stats();
+	return NULL;
+}
 
-	/* since the move calculated is valid, setting can_be_dest of the target to true to make it work with chess_engine.c:move_piece function. */
-	board->tiles[best_move.dest_tile[0]][best_move.dest_tile[1]].can_be_dest = true;
-	bool return_value = move_piece(board, best_move.dest_tile, best_move.src_tile, history);
-	clear_dest(board);
 
-	return return_value;
+/* iterative deepening of one thread, every other helper starts a ply deeper so that threads spread over depths instead of racing on one */
+static void iterate (search_t *search) {
+	smp_t *smp = search->smp;
+	board_value_t last_value = relative_eval(search, &search->board);
+	for (int depth = 1 + (search->id & 1); depth <= smp->ai.depth; depth++) {
+		scored_move_t iteration = search_root(&search->board, search, last_value, depth);
+		if (search->is_stopped)
+			break;
+
+		last_value = iteration.board_value;
+		search->root_move = iteration.move;
+		pthread_mutex_lock(&smp->lock);
+		if (depth > smp->depth) {
+			smp->best_move = iteration;
+			smp->depth = depth;
+		}
+		pthread_mutex_unlock(&smp->lock);
+
+		double soft_limit = atomic_load(&smp->soft_limit);
+		if (depth == smp->ai.depth || (search->id == 0 && soft_limit > 0 && elapsed_secs(&smp->start) >= soft_limit))
+			atomic_store(&smp->is_stopped, true);
+		if (atomic_load(&smp->is_stopped))
+			break;
+	}
 }
 
 
-static move_t _minimax_ab (board_t *board, history_t *history, board_value_t alpha, board_value_t beta, int depth, board_value_t (*eval_func)(const board_t *board)) {
-	move_t best_move;
-	best_move.board_value = (*eval_func)(board);
-	best_move.src_tile[0] = -1;
-	best_move.src_tile[1] = -1;
-	best_move.dest_tile[0] = -1;
-	best_move.dest_tile[1] = -1;
-	if (depth == 0 || is_game_finished(board, history))
+/* aspiration: window around value of last iteration is widened on the failing side till the value falls inside it */
+static scored_move_t search_root (board_t *board, search_t *search, board_value_t last_value, int depth) {
+	if (depth == 1)
+		return _minimax_ab(board, search, -INFINITE_VALUE, INFINITE_VALUE, depth, 0);
+
+	board_value_t window = ASPIRATION_WINDOW;
+	board_value_t alpha = last_value - window, beta = last_value + window;
+	while (true) {
+		scored_move_t best_move = _minimax_ab(board, search, alpha, beta, depth, 0);
+		if (search->is_stopped)
+			return best_move;
+
+		window *= 2;
+		if (best_move.board_value <= alpha)
+			alpha = (window > MAX_ASPIRATION ? -INFINITE_VALUE: best_move.board_value - window);
+		else if (best_move.board_value >= beta)
+			beta = (window > MAX_ASPIRATION ? INFINITE_VALUE: best_move.board_value + window);
+		else
+			return best_move;
+		search->researches++;
+	}
+}
+
+
+/*
+ * Negamax form of minimax, board_value is from the side to move's point of view and a child's value is negated for its parent.
+ * Principal variation search: first move is searched with the full window, rest only prove with a null window that they are worse
+ * and are searched again with the full window when one is not.
+ */
+static scored_move_t _minimax_ab (board_t *board, search_t *search, board_value_t alpha, board_value_t beta, int depth, int ply) {
+	scored_move_t best_move;
+	best_move.move = NULL_MOVE;
+	count_node(search);
+
+	// search arrays are indexed by ply, past their end the static eval stands in
+	if (ply >= MAX_SEARCH_PLIES) {
+		best_move.board_value = relative_eval(search, board);
 		return best_move;
+	}
 
-	unsigned long long int moves_capacity = 50;
-	unsigned long long int moves_count = 0;
-	move_t *moves = (move_t *) malloc(moves_capacity * sizeof(move_t));
-	for (int i = 0; i < 8; i++) {
-		for (int j = 0; j < 8; j++) {
-			piece_t *piece = board->tiles[i][j].piece;
-			if (piece == NULL || (piece->face & BLACK) != (board->chance & BLACK))
-				continue;
-			tile_t **piece_moves = find_moves(board, &(board->tiles[i][j]), history);
-			if (piece_moves == NULL)
-				continue;
-			for (int k = 0; k < MAX_MOVES && piece_moves[k] != NULL; k++) {
-				if (moves_count < moves_capacity) {
-					moves[moves_count].src_tile[0] = i;
-					moves[moves_count].src_tile[1] = j;
-					moves[moves_count].dest_tile[0] = piece_moves[k]->row;
-					moves[moves_count].dest_tile[1] = piece_moves[k]->col;
-					moves_count++;
-				} else {
-					if (moves_capacity >= ULLONG_MAX/2) {
-						moves_capacity = ULLONG_MAX;
-					} else {
-						moves_capacity <<= 1;
-					}
-					moves = realloc(moves, moves_capacity * sizeof(move_t));
-					if (moves == NULL) {
-						fprintf(stderr, "catn't run minimax_ab ai... too much possible moves!");
-						exit(EXIT_FAILURE);
-					}
-					moves[moves_count].src_tile[0] = i;
-					moves[moves_count].src_tile[1] = j;
-					moves[moves_count].dest_tile[0] = piece_moves[k]->row;
-					moves[moves_count].dest_tile[1] = piece_moves[k]->col;
-					moves_count++;
-				}
+	// a single repetition is enough in search, playing into it again can't be better for the side repeating
+	if (ply > 0 && find_draw(board, &search->stack, 1) != PENDING) {
+		best_move.board_value = DRAW_BOARD_VALUE;
+		return best_move;
+	}
+
+	// leaves are searched on till no captures are left, static eval mid exchange is off by the exchanged material
+	if (depth == 0) {
+		best_move.board_value = quiescence(board, search, alpha, beta, ply);
+		return best_move;
+	}
+
+	board_value_t static_eval = relative_eval(search, board);
+	best_move.board_value = static_eval;
+	if (board->result != PENDING)
+		return best_move;
+
+	// transposition searched as deep before can end the search or narrow the window, root always searches to find a move
+	board_value_t alpha_orig = alpha, beta_orig = beta;
+	tt_entry_t entry;
+	move_t tt_move = NULL_MOVE;
+	if (probe_tt(board->key, &entry)) {
+		tt_move = entry.move;
+		entry.board_value = value_from_tt(entry.board_value, ply);
+		if (ply > 0 && entry.depth >= depth) {
+			if (tt_bound(&entry) == TT_LOWER)
+				alpha = max(alpha, entry.board_value);
+			else if (tt_bound(&entry) == TT_UPPER)
+				beta = min(beta, entry.board_value);
+			if (tt_bound(&entry) == TT_EXACT || beta <= alpha) {
+				best_move.board_value = entry.board_value;
+				best_move.move = entry.move;
+				return best_move;
 			}
-			free(piece_moves);
 		}
 	}
 
-	if (moves_count == 0) {
-		free(moves);
+	bool is_pv = (beta - alpha > 1);
+	bool is_checked = in_check(board);
+
+	// razoring, far below alpha near leaves only captures can make up for it and quiescence finds them
+	if ((search->pruning & FUTILITY_PRUNING) && !is_pv && !is_checked && depth <= FUTILITY_DEPTH && static_eval + razor_margin(depth) <= alpha) {
+		board_value_t board_value = quiescence(board, search, alpha, alpha+1, ply);
+		if (board_value <= alpha) {
+			best_move.board_value = board_value;
+			return best_move;
+		}
+	}
+
+	// null move, if passing the turn still fails high a real move will too. not tried without pieces where passing may be the only good move
+	if ((search->pruning & NULL_MOVE_PRUNING) && !is_pv && !is_checked && ply > 0 && !search->after_null[ply] && depth >= NULL_MOVE_DEPTH
+			&& static_eval >= beta && has_pieces(board)) {
+		int reduced_depth = max(depth - 1 - null_move_reduction(depth), 0);
+		undo_t undo;
+		push_key(&search->stack, board->key);
+		make_null_move(board, &undo);
+		search->after_null[ply+1] = true;
+		board_value_t board_value = -_minimax_ab(board, search, -beta, -beta+1, reduced_depth, ply+1).board_value;
+		search->after_null[ply+1] = false;
+		unmake_null_move(board, &undo);
+		pop_key(&search->stack);
+		if (search->is_stopped)
+			return best_move;
+
+		// deep cutoffs are confirmed by a reduced search without null move
+		if (board_value >= beta && depth >= NULL_VERIFY_DEPTH) {
+			search->after_null[ply] = search->is_verifying[ply] = true;
+			board_value = _minimax_ab(board, search, beta-1, beta, reduced_depth, ply).board_value;
+			search->after_null[ply] = search->is_verifying[ply] = false;
+		}
+		// a mate found after passing isn't proven, only the cutoff is
+		if (board_value >= beta) {
+			best_move.board_value = (is_mate_value(board_value) ? beta: board_value);
+			return best_move;
+		}
+	}
+	bool is_futile = ((search->pruning & FUTILITY_PRUNING) && !is_pv && !is_checked && depth <= FUTILITY_DEPTH && static_eval + futility_margin(depth) <= alpha);
+
+	// no legal moves, mate or stalemate. nearer mates are worth more so that the side mating takes the shortest way
+	movelist_t list;
+	if (generate_moves(board, &list) == 0) {
+		best_move.board_value = (is_checked ? -(MATE_BOARD_VALUE - ply): DRAW_BOARD_VALUE);
 		return best_move;
 	}
 
-	shuffle(moves, moves_count, sizeof(moves[0]));
+	// best move stored for the position most likely is still the best, at root the one of last iteration is
+	if (ply == 0 && search->root_move != NULL_MOVE)
+		tt_move = search->root_move;
+	move_picker_t picker;
+	init_move_picker(&picker, board, &list, tt_move, &search->order, ply);
 
-	if (board->chance == WHITE) {
-		best_move.board_value = MIN_BOARD_VALUE;
-		for (int i = 0; i < moves_count; i++) {
-			// simulate the move
-			/* set board->is_fake as true to hint the chess_engine.c that HUMAN moves are being simulated (especially, chess_engine.c:move_piece). set before every move as the board is copied from history after undo and will set board->is_fake to false after copying last real board */
-// 			board->is_fake = true;	
-			/* since the moves array contains valid destinations, setting can_be_dest of the target to true to make it work with chess_engine.c:move_piece function. */
-// 			tile_t *dest[1] = { &(board->tiles[moves[i].dest_tile[0]][moves[i].dest_tile[1]]) };
-// 			set_dest(board, dest);
-			board->tiles[moves[i].dest_tile[0]][moves[i].dest_tile[1]].can_be_dest = true;
-			if(!move_piece(board, moves[i].dest_tile, moves[i].src_tile, history))
-				continue;
-			board->tiles[moves[i].dest_tile[0]][moves[i].dest_tile[1]].can_be_dest = false;
-
-			// evaluate
-			move_t move_eval = _minimax_ab(board, history, alpha, beta, depth-1, eval_func);
-			moves[i].board_value = move_eval.board_value;
-
-			// undo the move
-			undo(history);
-			copy_board(board, peek_board(history, 0));
-			
-			// updating best move with move with highest board_value
-			// order dependent strategy
-			if (moves[i].board_value > best_move.board_value) {
-				best_move = moves[i];
-			}
-			
-			/* not updating for equal evaluated moves as they might be result of unoptimized pruned branch */
-/* 			else if (moves[i].board_value == best_move.board_value) {
-				// use random strategy
-				// comment random strategy for reporducibility of same move and finiding bug in ab - pruning
-// 				if (rand() % (moves_count/2) == 0) {
-					best_move = moves[i];
-// 				}
-			} */
-
-			// update alpha
-			alpha = max(alpha, best_move.board_value);
-
-			// alpha-beta pruning
-			if (beta <= alpha)
-				break;
+	best_move.board_value = -INFINITE_VALUE;
+	move_t move;
+	for (int i = 0; (move = next_move(&picker)) != NULL_MOVE; i++) {
+		int score = picked_score(&picker);
+
+		// simulate the move
+		undo_t undo;
+		push_key(&search->stack, board->key);
+		make_move(board, move, &undo);
+
+		// quiet moves not giving check can't lift a futile node to alpha
+		bool is_quiet = !is_capture(move) && !is_promotion(move);
+		bool gives_check = in_check(board);
+		if (is_futile && i > 0 && is_quiet && !gives_check) {
+			unmake_move(board, move, &undo);
+			pop_key(&search->stack);
+			continue;
 		}
-	} else {
-		best_move.board_value = MAX_BOARD_VALUE;
-		for (int i = 0; i < moves_count; i++) {
-			// simulate the move
-			/* set board->is_fake as true to hint the chess_engine.c that HUMAN moves are being simulated (especially, chess_engine.c:move_piece). set before every move as the board is copied from history after undo and will set board->is_fake to false after copying last real board */
-// 			board->is_fake = true;	
-			/* since the moves array contains valid destinations, setting can_be_dest of the target to true to make it work with chess_engine.c:move_piece function. */
-// 			tile_t *dest[1] = { &(board->tiles[moves[i].dest_tile[0]][moves[i].dest_tile[1]]) };
-// 			set_dest(board, dest);
-			board->tiles[moves[i].dest_tile[0]][moves[i].dest_tile[1]].can_be_dest = true;
-			if(!move_piece(board, moves[i].dest_tile, moves[i].src_tile, history))
-				continue;
-			board->tiles[moves[i].dest_tile[0]][moves[i].dest_tile[1]].can_be_dest = false;
-
-			// evaluate
-			move_t move_eval = _minimax_ab(board, history, alpha, beta, depth-1, eval_func);
-			moves[i].board_value = move_eval.board_value;
-
-			// undo the move
-			undo(history);
-			copy_board(board, peek_board(history, 0));
-			
-			// updating best move with move with lowest board_value
-			// order dependent strategy
-			if (moves[i].board_value < best_move.board_value) {
-				best_move = moves[i];
-			}
-			 
-			/* not updating for equal evaluated moves as they might be result of unoptimized pruned branch */
-/* 			else if (moves[i].board_value == best_move.board_value) {
-				// use random strategy
-				// comment random strategy for reporducibility of same move and finiding bug in ab - pruning
-// 				if (rand() % (moves_count/2) == 0) {
-					best_move = moves[i];
-// 				}
-			} */
-
-			// update beta
-			beta = min(beta, best_move.board_value);
-
-			// alpha-beta pruning
-			if (beta <= alpha)
-				break;
+
+		// evaluate
+		board_value_t board_value;
+		if (i == 0)
+			board_value = -_minimax_ab(board, search, -beta, -alpha, depth-1, ply+1).board_value;
+		else {
+			// late quiet moves are unlikely to be best and are searched shallower, again at full depth if they beat alpha
+			int reduction = 0;
+			if ((search->pruning & LATE_MOVE_REDUCTIONS) && i >= LMR_MOVES && depth >= LMR_DEPTH && !is_checked && is_quiet && !gives_check && is_history_score(score))
+				reduction = late_move_reduction(depth, i, score);
+
+			board_value = -_minimax_ab(board, search, -alpha-1, -alpha, depth-1-reduction, ply+1).board_value;
+			if (reduction > 0 && board_value > alpha && !search->is_stopped)
+				board_value = -_minimax_ab(board, search, -alpha-1, -alpha, depth-1, ply+1).board_value;
+			if (board_value > alpha && board_value < beta && !search->is_stopped)
+				board_value = -_minimax_ab(board, search, -beta, -alpha, depth-1, ply+1).board_value;
 		}
+
+		// undo the move
+		unmake_move(board, move, &undo);
+		pop_key(&search->stack);
+		if (search->is_stopped)
+			return best_move;
+
+		/* updating best move only with strictly better moves, equal evaluated moves might be result of unoptimized pruned branch */
+		if (board_value > best_move.board_value) {
+			best_move.board_value = board_value;
+			best_move.move = move;
+		}
+		alpha = max(alpha, best_move.board_value);
+
+		// alpha-beta pruning
+		if (beta <= alpha) {
+			search->cutoffs++;
+			if (i == 0)
+				search->first_move_cutoffs++;
+			update_move_order(&search->order, board, move, depth, ply);
+			break;
+		}
+	}
+
+	if (!search->is_verifying[ply]) {
+		enum tt_bound bound = (best_move.board_value <= alpha_orig ? TT_UPPER: best_move.board_value >= beta_orig ? TT_LOWER: TT_EXACT);
+		store_tt(board->key, depth, bound, value_to_tt(best_move.board_value, ply), best_move.move);
 	}
 
-	// make the board->is_fake false before returning so that game can continue as normal for HUMAN, also AI will set board->is_fake to true before recursively calling this function anyway.
-// 	board->is_fake = false;
-	// clear_dest so that no tile remains marked as can_be_dest
-	clear_dest(board);
-	free(moves);
 	return best_move;
 }
+
+
+/*
+ * Captures only search at leaves, in negamax form as _minimax_ab. Side to move may stand pat with the static eval instead of capturing,
+ * except when in check where all evasions are searched. Captures losing material by static exchange or gaining too little to reach
+ * the window are skipped.
+ */
+static board_value_t quiescence (board_t *board, search_t *search, board_value_t alpha, board_value_t beta, int ply) {
+	count_node(search);
+
+	// captures and evasions can chain on past the plies the search arrays have room for, as in _minimax_ab the static eval stands in
+	if (ply >= MAX_SEARCH_PLIES)
+		return relative_eval(search, board);
+
+	board_value_t stand_pat = relative_eval(search, board);
+	bool is_evading = in_check(board);
+	if (!is_evading) {
+		if (stand_pat >= beta)
+			return stand_pat;
+		alpha = max(alpha, stand_pat);
+	}
+
+	// no legal moves, mate or stalemate
+	movelist_t list;
+	if (generate_moves(board, &list) == 0)
+		return (is_evading ? -(MATE_BOARD_VALUE - ply): DRAW_BOARD_VALUE);
+
+	move_picker_t picker;
+	init_move_picker(&picker, board, &list, NULL_MOVE, &search->order, ply);
+
+	board_value_t best_value = (is_evading ? -INFINITE_VALUE: stand_pat);
+	move_t move;
+	while ((move = next_move(&picker)) != NULL_MOVE) {
+		if (!is_evading) {
+			if (!is_capture(move) && !is_promotion(move))
+				continue;
+			int gain = see(board, move);
+			if (gain < 0 || stand_pat + gain + DELTA_MARGIN <= alpha)
+				continue;
+		}
+
+		undo_t undo;
+		make_move(board, move, &undo);
+		board_value_t board_value = -quiescence(board, search, -beta, -alpha, ply+1);
+		unmake_move(board, move, &undo);
+		if (search->is_stopped)
+			return best_value;
+
+		best_value = max(best_value, board_value);
+		alpha = max(alpha, best_value);
+		if (beta <= alpha)
+			break;
+	}
+
+	return best_value;
+}
+
+
+/* side to move has a piece other than king and pawns, positions with only those are the usual zugzwangs */
+static bool has_pieces (const board_t *board) {
+	int color = is_black(board->chance);
+	return (board->occupied[color] & ~board->pieces[color][piece_index(KING)] & ~board->pieces[color][piece_index(PAWN)]) != EMPTY_BB;
+}
+
+
+/* mate values count plies from root, in the table they count from the stored position so that they hold wherever it is reached from */
+static board_value_t value_to_tt (board_value_t board_value, int ply) {
+	if (!is_mate_value(board_value))
+		return board_value;
+	return (board_value > 0 ? board_value + ply: board_value - ply);
+}
+
+
+static board_value_t value_from_tt (board_value_t board_value, int ply) {
+	if (!is_mate_value(board_value))
+		return board_value;
+	return (board_value > 0 ? board_value - ply: board_value + ply);
+}
+
+
+/* reduction grows with move's rank and node's depth, moves with a history of cutoffs are reduced less. at least a ply is left to search */
+static int late_move_reduction (int depth, int move_count, int score) {
+	int reduction = 1 + (move_count >= 2 * LMR_MOVES) + (depth >= 2 * LMR_DEPTH);
+	if (score >= GOOD_HISTORY)
+		reduction--;
+	return min(reduction, depth - 2);
+}
+
+
+/* every few nodes checks the clock, stopping all threads at hard limit, and whether another thread stopped them */
+static void count_node (search_t *search) {
+	search->nodes++;
+	if ((search->nodes & TIME_CHECK_NODES) != 0)
+		return;
+
+	smp_t *smp = search->smp;
+	double hard_limit = atomic_load(&smp->hard_limit);
+	if (hard_limit > 0 && elapsed_secs(&smp->start) >= hard_limit)
+		atomic_store(&smp->is_stopped, true);
+	search->is_stopped = atomic_load(&smp->is_stopped);
+}
+
+
+/* soft limit is an even share of the clock between the moves expected to be left, hard limit is a few shares but at most a quarter of the clock */
+static void find_time_budget (int remaining_secs, int move_number, double *soft_limit, double *hard_limit) {
+	int moves_to_go = max(EXPECTED_GAME_MOVES - move_number, MIN_MOVES_TO_GO);
+	*soft_limit = (double) remaining_secs / moves_to_go;
+	*hard_limit = min(*soft_limit * MAX_MOVE_SHARES, remaining_secs / 4.0);
+	// clock shows whole secs, last one may be almost gone
+	if (remaining_secs <= 1)
+		*soft_limit = *hard_limit = 0.05;
+}
+
+
+static double elapsed_secs (const struct timespec *start) {
+	struct timespec end;
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	return (end.tv_sec - start->tv_sec) + (end.tv_nsec - start->tv_nsec) / 1e9;
+}
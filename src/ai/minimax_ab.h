@@ -4,16 +4,40 @@
 #include "eval_funcs.h"
 #include "../core/board.h"
 #include "../core/history.h"
+#include "../core/chess_engine.h"	// move_t
 
 #define	MAX_AI_DEPTH 5
+#define	MAX_SEARCH_THREADS	64
+
+/* selective search techniques, each can be turned off to measure what it brings */
+enum	pruning	{ NULL_MOVE_PRUNING = 1, LATE_MOVE_REDUCTIONS = 2, FUTILITY_PRUNING = 4, ALL_PRUNING = 7 };
 
 
 typedef struct {
 	int depth;
 	board_value_t (*eval_func)(const board_t *board);
+	int pruning;	// mask of enum pruning
 } minimax_ab_ai_t;
 
 
-bool	minimax_ab_play	(board_t *board, history_t *history, const minimax_ab_ai_t minimax_ab_ai);
+typedef struct {
+	move_t move;
+	board_value_t board_value;
+	long long nodes;
+	long long cutoffs;				// nodes cut off by alpha-beta
+	long long first_move_cutoffs;	// of them, ones cut off by first move searched, measures move ordering
+	long long researches;			// root searches repeated after value fell outside aspiration window
+	int depth;	// depth of deepest iteration completed by any thread
+	int threads;
+	double secs;
+} search_result_t;
+
+
+bool	minimax_ab_play		(board_t *board, history_t *history, const minimax_ab_ai_t minimax_ab_ai);
+move_t	minimax_ab_search	(const board_t *board, const history_t *history, const minimax_ab_ai_t minimax_ab_ai, search_result_t *result);
+void	set_search_threads	(int threads);
+int		get_search_threads	(void);
+bool	get_last_search		(search_result_t *result);
+void	stop_pondering		(void);
 
 #endif
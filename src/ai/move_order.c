@@ -0,0 +1,96 @@
+#include <string.h>
+
+#include "move_order.h"
+
+#define	mvv_lva(victim, attacker)	(MVV_LVA_VALUES[victim] * 8 - MVV_LVA_VALUES[attacker])
+
+static	const	int	MVV_LVA_VALUES[PIECE_TYPES]	=	{ 6, 5, 4, 3, 3, 1 };	// in same order as board.c:PIECES
+
+static	int		score_move		(const board_t *board, move_t move, move_t hash_move, const move_order_t *order, int ply);
+static	bool	is_quiet		(move_t move);
+
+
+void clear_move_order (move_order_t *order) {
+	memset(order, 0, sizeof(move_order_t));
+}
+
+
+void init_move_picker (move_picker_t *picker, const board_t *board, const movelist_t *list, move_t hash_move, const move_order_t *order, int ply) {
+	picker->count = list->count;
+	picker->next = 0;
+	for (int i = 0; i < list->count; i++) {
+		picker->moves[i] = list->moves[i];
+		picker->scores[i] = score_move(board, list->moves[i], hash_move, order, ply);
+	}
+}
+
+
+/* NULL_MOVE once all moves are picked */
+move_t next_move (move_picker_t *picker) {
+	if (picker->next == picker->count)
+		return NULL_MOVE;
+
+	int best = picker->next;
+	for (int i = picker->next + 1; i < picker->count; i++)
+		if (picker->scores[i] > picker->scores[best])
+			best = i;
+
+	move_t move = picker->moves[best];
+	picker->moves[best] = picker->moves[picker->next];
+	picker->scores[best] = picker->scores[picker->next];
+	picker->next++;
+	return move;
+}
+
+
+/* called with the move that caused a cutoff, board is the position it was played in. captures and promotions are already ordered well by mvv-lva */
+void update_move_order (move_order_t *order, const board_t *board, move_t move, int depth, int ply) {
+	if (!is_quiet(move))
+		return;
+
+	if (ply < MAX_SEARCH_PLIES && order->killers[ply][0] != move) {
+		for (int k = KILLER_SLOTS - 1; k > 0; k--)
+			order->killers[ply][k] = order->killers[ply][k-1];
+		order->killers[ply][0] = move;
+	}
+
+	int *score = &order->history[is_black(board->chance)][move_from(move)][move_to(move)];
+	*score += depth * depth;
+	// keep recent cutoffs weighing more than old ones
+	if (*score >= MAX_HISTORY) {
+		int *scores = &order->history[0][0][0];
+		for (size_t i = 0; i < sizeof(order->history) / sizeof(int); i++)
+			scores[i] /= 2;
+	}
+}
+
+
+static int score_move (const board_t *board, move_t move, move_t hash_move, const move_order_t *order, int ply) {
+	if (move == hash_move)
+		return HASH_MOVE_SCORE;
+
+	int from = move_from(move), to = move_to(move);
+	int attacker = piece_index(board->tiles[square_row(from)][square_col(from)].piece.face);
+	if (!is_quiet(move)) {
+		int score = CAPTURE_SCORE;
+		if (move_flags(move) == EN_PASSANT)
+			score += mvv_lva(piece_index(PAWN), attacker);
+		else if (is_capture(move))
+			score += mvv_lva(piece_index(board->tiles[square_row(to)][square_col(to)].piece.face), attacker);
+		// promoted piece counts as captured, so queen promotions come before most captures and under promotions late among them
+		if (is_promotion(move))
+			score += mvv_lva(piece_index(promotion_face(move)), attacker);
+		return score;
+	}
+
+	for (int k = 0; ply < MAX_SEARCH_PLIES && k < KILLER_SLOTS; k++)
+		if (order->killers[ply][k] == move)
+			return KILLER_SCORE - k;
+
+	return order->history[is_black(board->chance)][from][to];
+}
+
+
+static bool is_quiet (move_t move) {
+	return !is_capture(move) && !is_promotion(move);
+}
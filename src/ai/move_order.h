@@ -0,0 +1,39 @@
+#ifndef MOVE_ORDER_H
+#define MOVE_ORDER_H
+
+#include "../core/board.h"
+#include "../core/chess_engine.h"
+#include "../core/draw.h"	// MAX_SEARCH_PLIES
+
+#define	KILLER_SLOTS	2
+#define	MAX_HISTORY		(1 << 20)	// history scores are halved once one reaches it, keeping them below killer scores
+
+// score bands of move kinds, a move of a band is always tried before any move of a lower one. quiet moves score their history
+#define	HASH_MOVE_SCORE		(1 << 30)
+#define	CAPTURE_SCORE		(1 << 28)	// plus mvv-lva of the capture
+#define	KILLER_SCORE		(1 << 26)	// minus killer slot
+#define	is_history_score(score)	((score) < KILLER_SCORE - KILLER_SLOTS)
+
+#define	picked_score(picker)	((picker)->scores[(picker)->next - 1])	// score of move last returned by next_move
+
+/* what search learnt about quiet moves, kept across iterations of one search */
+typedef struct {
+	move_t killers[MAX_SEARCH_PLIES][KILLER_SLOTS];	// quiet moves that last caused a cutoff at a ply, most recent first
+	int history[2][64][64];		// indexed by color, from and to square, grows with depth of cutoffs caused by the quiet move
+} move_order_t;
+
+/* moves of a node handed out best first, moves are scored once and picked by selection so that nodes cut off early don't sort the whole list */
+typedef struct {
+	move_t moves[MAX_GAME_MOVES];
+	int scores[MAX_GAME_MOVES];
+	int count;
+	int next;
+} move_picker_t;
+
+
+void	clear_move_order	(move_order_t *order);
+void	init_move_picker	(move_picker_t *picker, const board_t *board, const movelist_t *list, move_t hash_move, const move_order_t *order, int ply);
+move_t	next_move			(move_picker_t *picker);
+void	update_move_order	(move_order_t *order, const board_t *board, move_t move, int depth, int ply);
+
+#endif
@@ -0,0 +1,88 @@
+#include "see.h"
+#include "../utils/common.h"	// max
+
+#define	MAX_EXCHANGES	32
+
+static	const	int	SEE_VALUES[PIECE_TYPES]	=	{ SEE_KING_VALUE, 9, 5, 3, 3, 1 };	// in same order as board.c:PIECES, as in eval_funcs.c
+static	const	int	CHEAPEST_FIRST[PIECE_TYPES]	=	{ 5, 4, 3, 2, 1, 0 };	// piece indices, pawn to king
+
+static	bitboard_t	attackers_to		(const board_t *board, int sq, bitboard_t occupied);
+static	bitboard_t	least_valuable		(const board_t *board, bitboard_t attackers, int color, int *type);
+
+
+int see_value (face_t face) {
+	return (face == NO_PIECE ? 0: SEE_VALUES[piece_index(face)]);
+}
+
+
+/*
+ * Material won (in pawns) by side to move when both sides keep capturing on the target square of move with their least valuable piece,
+ * each side stopping when that is better for it. Sliders behind the capturers (x-rays) join in. Pins and checks are ignored.
+ */
+int see (const board_t *board, move_t move) {
+	int from = move_from(move), to = move_to(move);
+	int color = is_black(board->chance);
+	int type = piece_index(board->tiles[square_row(from)][square_col(from)].piece.face);
+	bitboard_t occupied = occupancy(board);
+	int gain[MAX_EXCHANGES];
+	int d = 0;
+
+	if (move_flags(move) == EN_PASSANT) {
+		gain[0] = SEE_VALUES[piece_index(PAWN)];
+		occupied ^= square_bb(color ? to + 8: to - 8);
+	} else
+		gain[0] = see_value(board->tiles[square_row(to)][square_col(to)].piece.face);
+
+	// promoted piece is the one standing on the square to be captured
+	if (is_promotion(move)) {
+		gain[0] += SEE_VALUES[piece_index(promotion_face(move))] - SEE_VALUES[piece_index(PAWN)];
+		type = piece_index(promotion_face(move));
+	}
+
+	bitboard_t from_bb = square_bb(from);
+	while (d + 1 < MAX_EXCHANGES) {
+		occupied ^= from_bb;
+		color = !color;
+		int captured = type;
+		from_bb = least_valuable(board, attackers_to(board, to, occupied) & occupied, color, &type);
+		if (from_bb == EMPTY_BB)
+			break;
+
+		d++;
+		gain[d] = SEE_VALUES[captured] - gain[d-1];
+		// neither side can gain from going on
+		if (max(-gain[d-1], gain[d]) < 0)
+			break;
+	}
+
+	// each side takes the better of capturing and standing pat, from the last capture back to the first
+	for (; d > 0; d--)
+		gain[d-1] = -max(-gain[d-1], gain[d]);
+	return gain[0];
+}
+
+
+/* pieces of both colors attacking sq through occupied, sliders see through squares left out of occupied */
+static bitboard_t attackers_to (const board_t *board, int sq, bitboard_t occupied) {
+	const bitboard_t (*pieces)[PIECE_TYPES] = board->pieces;
+	bitboard_t orthogonal = pieces[0][piece_index(QUEEN)] | pieces[1][piece_index(QUEEN)] | pieces[0][piece_index(ROOK)] | pieces[1][piece_index(ROOK)];
+	bitboard_t diagonal = pieces[0][piece_index(QUEEN)] | pieces[1][piece_index(QUEEN)] | pieces[0][piece_index(BISHOP)] | pieces[1][piece_index(BISHOP)];
+
+	return (PAWN_ATTACKS[1][sq] & pieces[0][piece_index(PAWN)]) | (PAWN_ATTACKS[0][sq] & pieces[1][piece_index(PAWN)])
+		| (KNIGHT_ATTACKS[sq] & (pieces[0][piece_index(KNIGHT)] | pieces[1][piece_index(KNIGHT)]))
+		| (KING_ATTACKS[sq] & (pieces[0][piece_index(KING)] | pieces[1][piece_index(KING)]))
+		| (rook_attacks(sq, occupied) & orthogonal) | (bishop_attacks(sq, occupied) & diagonal);
+}
+
+
+/* square (as bitboard) of least valuable of attackers of color, EMPTY_BB if it has none */
+static bitboard_t least_valuable (const board_t *board, bitboard_t attackers, int color, int *type) {
+	for (int k = 0; k < PIECE_TYPES; k++) {
+		bitboard_t bb = attackers & board->pieces[color][CHEAPEST_FIRST[k]];
+		if (bb) {
+			*type = CHEAPEST_FIRST[k];
+			return bb & -bb;
+		}
+	}
+	return EMPTY_BB;
+}
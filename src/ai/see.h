@@ -0,0 +1,13 @@
+#ifndef SEE_H
+#define SEE_H
+
+#include "../core/board.h"
+#include "../core/chess_engine.h"
+
+#define	SEE_KING_VALUE	100	// more than all other material, so exchanges never profit from putting the king en prise
+
+
+int		see_value	(face_t face);
+int		see			(const board_t *board, move_t move);
+
+#endif
@@ -0,0 +1,170 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+#include "tt.h"
+
+#define	AGE_MASK	63
+
+/*
+ * lock is key ^ data, a torn write by another thread fails the check instead of giving a wrong entry. each half is atomic on its own,
+ * relaxed order is enough as the xor check and not the order of the halves is what keeps entries whole
+ */
+typedef struct {
+	_Atomic uint64_t lock;
+	_Atomic uint64_t data;	// rest of the entry, packed by pack_entry
+} tt_slot_t;
+
+static	tt_slot_t		*table			=	NULL;
+static	uint64_t		buckets_mask	=	0;	// no. of buckets - 1
+static	size_t			size_mb			=	0;
+static	uint8_t			age				=	0;
+static	tt_stats_t		stats;							// of all threads, threads count in their own stats and add them with flush_tt_stats
+static	_Thread_local	tt_stats_t	thread_stats;
+static	pthread_mutex_t	stats_lock		=	PTHREAD_MUTEX_INITIALIZER;
+
+static	uint64_t	pack_entry		(const tt_entry_t *entry);
+static	void		unpack_entry	(uint64_t key, uint64_t data, tt_entry_t *entry);
+static	int			replace_value	(const tt_entry_t *entry);
+
+
+/* size is rounded down to a power of two buckets, previous table is freed. returns false (and leaves no table) if memory couldn't be allocated */
+bool init_tt (size_t mb) {
+	free(table);
+	table = NULL;
+	buckets_mask = 0;
+	size_mb = 0;
+
+	size_t bucket_size = TT_BUCKET_ENTRIES * sizeof(tt_slot_t);
+	uint64_t buckets = 1;
+	while (buckets * 2 * bucket_size <= (uint64_t) mb << 20)
+		buckets *= 2;
+
+	table = (tt_slot_t *) aligned_alloc(bucket_size, buckets * bucket_size);
+	if (table == NULL)
+		return false;
+	buckets_mask = buckets - 1;
+	size_mb = mb;
+	clear_tt();
+	return true;
+}
+
+
+void clear_tt (void) {
+	if (table)
+		memset(table, 0, (buckets_mask + 1) * TT_BUCKET_ENTRIES * sizeof(tt_slot_t));
+	memset(&stats, 0, sizeof(stats));
+	memset(&thread_stats, 0, sizeof(thread_stats));
+	age = 0;
+}
+
+
+// entries stored by earlier searches are replaced first
+void new_tt_search (void) {
+	age = (age + 1) & AGE_MASK;
+}
+
+
+/* copies the entry of key into entry, returns false if there is none */
+bool probe_tt (uint64_t key, tt_entry_t *entry) {
+	if (table == NULL)
+		return false;
+
+	thread_stats.probes++;
+	const tt_slot_t *bucket = &table[(key & buckets_mask) * TT_BUCKET_ENTRIES];
+	for (int i = 0; i < TT_BUCKET_ENTRIES; i++) {
+		uint64_t data = atomic_load_explicit(&bucket[i].data, memory_order_relaxed);
+		if ((atomic_load_explicit(&bucket[i].lock, memory_order_relaxed) ^ data) == key && data != 0) {
+			unpack_entry(key, data, entry);
+			thread_stats.hits++;
+			return true;
+		}
+	}
+	return false;
+}
+
+
+/* same position is always overwritten, otherwise an empty entry or the one least worth keeping */
+void store_tt (uint64_t key, int depth, enum tt_bound bound, board_value_t board_value, move_t move) {
+	if (table == NULL)
+		return;
+
+	tt_slot_t *bucket = &table[(key & buckets_mask) * TT_BUCKET_ENTRIES];
+	tt_slot_t *victim = bucket;
+	tt_entry_t victim_entry, entry;
+	for (int i = 0; i < TT_BUCKET_ENTRIES; i++) {
+		uint64_t data = atomic_load_explicit(&bucket[i].data, memory_order_relaxed);
+		unpack_entry(atomic_load_explicit(&bucket[i].lock, memory_order_relaxed) ^ data, data, &entry);
+		if (entry.key == key || tt_bound(&entry) == TT_NONE) {
+			victim = &bucket[i];
+			victim_entry = entry;
+			break;
+		}
+		if (i == 0 || replace_value(&entry) < replace_value(&victim_entry)) {
+			victim = &bucket[i];
+			victim_entry = entry;
+		}
+	}
+
+	thread_stats.stores++;
+	if (victim_entry.key != key && tt_bound(&victim_entry) != TT_NONE)
+		thread_stats.collisions++;
+	// a cut off search may not find a move, keep the one found earlier for the position
+	if (victim_entry.key == key && move == NULL_MOVE)
+		move = victim_entry.move;
+
+	entry.key = key;
+	entry.board_value = board_value;
+	entry.move = move;
+	entry.depth = depth;
+	entry.bound_age = bound | (age << 2);
+	uint64_t data = pack_entry(&entry);
+	atomic_store_explicit(&victim->data, data, memory_order_relaxed);
+	atomic_store_explicit(&victim->lock, key ^ data, memory_order_relaxed);
+}
+
+
+size_t get_tt_size_mb (void) {
+	return size_mb;
+}
+
+
+/* stats of all threads that flushed theirs, calling thread's included */
+tt_stats_t get_tt_stats (void) {
+	flush_tt_stats();
+	return stats;
+}
+
+
+// search threads call it before they end
+void flush_tt_stats (void) {
+	pthread_mutex_lock(&stats_lock);
+	stats.probes += thread_stats.probes;
+	stats.hits += thread_stats.hits;
+	stats.stores += thread_stats.stores;
+	stats.collisions += thread_stats.collisions;
+	pthread_mutex_unlock(&stats_lock);
+	memset(&thread_stats, 0, sizeof(thread_stats));
+}
+
+
+// bound is never TT_NONE in a stored entry, so data of a stored entry is never 0
+static uint64_t pack_entry (const tt_entry_t *entry) {
+	return (uint32_t) entry->board_value | ((uint64_t) entry->move << 32) | ((uint64_t) (uint8_t) entry->depth << 48) | ((uint64_t) entry->bound_age << 56);
+}
+
+
+static void unpack_entry (uint64_t key, uint64_t data, tt_entry_t *entry) {
+	entry->key = key;
+	entry->board_value = (int32_t) (uint32_t) data;
+	entry->move = (move_t) (data >> 32);
+	entry->depth = (int8_t) (data >> 48);
+	entry->bound_age = (uint8_t) (data >> 56);
+}
+
+
+// deeper entries are worth more, each search since the entry was stored costs it 4 plies
+static int replace_value (const tt_entry_t *entry) {
+	return entry->depth - 4 * ((age - tt_age(entry)) & AGE_MASK);
+}
@@ -0,0 +1,45 @@
+#ifndef TT_H
+#define TT_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "eval_funcs.h"
+#include "../core/chess_engine.h"
+
+#define	DEFAULT_TT_MB		16
+#define	TT_BUCKET_ENTRIES	4	// slots are 16 bytes, so a bucket fills one 64 byte cache line
+
+#define	tt_bound(entry)		((enum tt_bound) ((entry)->bound_age & 3))
+#define	tt_age(entry)		((entry)->bound_age >> 2)
+
+/* board_value is exact or a bound on it when search of the position was cut off */
+enum	tt_bound	{ TT_NONE, TT_EXACT, TT_LOWER, TT_UPPER };
+
+/* table is shared by search threads without locks, entries are packed into a slot on store and unpacked on probe */
+typedef struct {
+	uint64_t key;
+	int32_t board_value;
+	move_t move;		// best move found, NULL_MOVE if none
+	int8_t depth;
+	uint8_t bound_age;	// bound in low 2 bits, age of the search that stored it in the rest
+} tt_entry_t;
+
+typedef struct {
+	uint64_t probes;
+	uint64_t hits;
+	uint64_t stores;
+	uint64_t collisions;	// stores that evicted the entry of another position
+} tt_stats_t;
+
+
+bool		init_tt			(size_t size_mb);
+void		clear_tt		(void);
+void		new_tt_search	(void);
+bool		probe_tt		(uint64_t key, tt_entry_t *entry);
+void		store_tt		(uint64_t key, int depth, enum tt_bound bound, board_value_t board_value, move_t move);
+size_t		get_tt_size_mb	(void);
+tt_stats_t	get_tt_stats	(void);
+void		flush_tt_stats	(void);
+
+#endif
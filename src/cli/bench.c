@@ -0,0 +1,175 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "bench.h"
+#include "cli_util.h"
+#include "../core/bitboard.h"
+#include "../core/setwise.h"
+
+#define	BENCH_OCCUPANCIES	4096
+#define	BENCH_ROUNDS		8
+
+typedef struct {
+	bitboard_t	orthogonal[2];
+	bitboard_t	diagonal[2];
+	bitboard_t	empty;
+} bench_position_t;
+
+static	int			bench_slider_kernels	(void);
+static	int			bench_fill_kernels		(void);
+static	void		loop_attack_maps		(const bench_position_t *position, bitboard_t attacks[2]);
+static	bitboard_t	bench_random	(void);
+
+
+int run_bench (void) {
+	init_bitboards();
+	int status = bench_slider_kernels();
+	printf("\n");
+	if (bench_fill_kernels() != EXIT_SUCCESS)
+		status = EXIT_FAILURE;
+	return status;
+}
+
+
+/* microbenchmark of the slider attack kernels, the walk kernel is the square by square ray walk of the old ADD_*_MOVES macros */
+static int bench_slider_kernels (void) {
+	enum slider_kernel default_kernel = get_slider_kernel();
+
+	bitboard_t *occupancies = (bitboard_t *) malloc(BENCH_OCCUPANCIES * sizeof(bitboard_t));
+	if (occupancies == NULL) {
+		fprintf(stderr, "couldn't allocate memory for bench\n");
+		return EXIT_FAILURE;
+	}
+	// sparse and dense boards alike
+	for (int k = 0; k < BENCH_OCCUPANCIES; k++)
+		occupancies[k] = (k & 1) ? bench_random() & bench_random(): bench_random() & bench_random() & bench_random();
+
+	const long long lookups = 2LL * 64 * BENCH_OCCUPANCIES * BENCH_ROUNDS;
+	bitboard_t reference = EMPTY_BB;
+	double walk_secs = 0;
+	int status = EXIT_SUCCESS;
+
+	printf("%-8s %12s %12s %10s %8s\n", "kernel", "lookups", "ns/lookup", "speedup", "check");
+	for (int kernel = 0; kernel < SLIDER_KERNELS; kernel++) {
+		if (!set_slider_kernel(kernel)) {
+			printf("%-8s %12s\n", SLIDER_KERNEL_NAMES[kernel], "unsupported");
+			continue;
+		}
+
+		bitboard_t checksum = EMPTY_BB;
+		struct timespec start;
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		for (int round = 0; round < BENCH_ROUNDS; round++) {
+			for (int k = 0; k < BENCH_OCCUPANCIES; k++) {
+				for (int sq = 0; sq < 64; sq++) {
+					checksum ^= rook_attacks(sq, occupancies[k]);
+					checksum += bishop_attacks(sq, occupancies[k]);
+				}
+			}
+		}
+		double secs = elapsed_secs(&start);
+
+		if (kernel == WALK_KERNEL) {
+			reference = checksum;
+			walk_secs = secs;
+		}
+		bool is_ok = (checksum == reference);
+		if (!is_ok)
+			status = EXIT_FAILURE;
+		printf("%-8s %12lld %12.2f %9.2fx %8s\n", SLIDER_KERNEL_NAMES[kernel], lookups, secs * 1e9 / lookups, walk_secs / secs, (is_ok ? "ok": "MISMATCH"));
+	}
+
+	set_slider_kernel(default_kernel);
+	printf("default kernel: %s\n", SLIDER_KERNEL_NAMES[default_kernel]);
+	free(occupancies);
+
+	return status;
+}
+
+
+/* attack maps of both colors for random positions, per piece table lookups against set-wise fills */
+static int bench_fill_kernels (void) {
+	enum fill_kernel default_kernel = get_fill_kernel();
+
+	bench_position_t *positions = (bench_position_t *) malloc(BENCH_OCCUPANCIES * sizeof(bench_position_t));
+	if (positions == NULL) {
+		fprintf(stderr, "couldn't allocate memory for bench\n");
+		return EXIT_FAILURE;
+	}
+	for (int k = 0; k < BENCH_OCCUPANCIES; k++) {
+		bitboard_t occupied = bench_random() & bench_random();
+		for (int color = 0; color < 2; color++) {
+			positions[k].orthogonal[color] = occupied & bench_random() & bench_random() & bench_random();
+			positions[k].diagonal[color] = occupied & bench_random() & bench_random() & bench_random();
+		}
+		positions[k].empty = ~occupied;
+	}
+
+	const long long maps = (long long) BENCH_OCCUPANCIES * BENCH_ROUNDS * 8;
+	bitboard_t reference = EMPTY_BB;
+	double loop_secs = 0;
+	int status = EXIT_SUCCESS;
+
+	printf("%-8s %12s %12s %10s %8s\n", "fill", "maps", "ns/map", "speedup", "check");
+	for (int kernel = -1; kernel < FILL_KERNELS; kernel++) {
+		// -1 is the per piece loop over the default slider kernel
+		if (kernel >= 0 && !set_fill_kernel(kernel)) {
+			printf("%-8s %12s\n", FILL_KERNEL_NAMES[kernel], "unsupported");
+			continue;
+		}
+
+		bitboard_t checksum = EMPTY_BB;
+		struct timespec start;
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		for (int round = 0; round < BENCH_ROUNDS * 8; round++) {
+			for (int k = 0; k < BENCH_OCCUPANCIES; k++) {
+				bitboard_t attacks[2];
+				if (kernel < 0)
+					loop_attack_maps(&positions[k], attacks);
+				else
+					slider_attacks_setwise(positions[k].orthogonal, positions[k].diagonal, positions[k].empty, attacks);
+				checksum = (checksum ^ attacks[0]) + attacks[1];
+			}
+		}
+		double secs = elapsed_secs(&start);
+
+		if (kernel < 0) {
+			reference = checksum;
+			loop_secs = secs;
+		}
+		bool is_ok = (checksum == reference);
+		if (!is_ok)
+			status = EXIT_FAILURE;
+		printf("%-8s %12lld %12.2f %9.2fx %8s\n", (kernel < 0 ? "loop": FILL_KERNEL_NAMES[kernel]), maps, secs * 1e9 / maps, loop_secs / secs, (is_ok ? "ok": "MISMATCH"));
+	}
+
+	set_fill_kernel(default_kernel);
+	printf("default fill: %s\n", FILL_KERNEL_NAMES[default_kernel]);
+	free(positions);
+
+	return status;
+}
+
+
+static void loop_attack_maps (const bench_position_t *position, bitboard_t attacks[2]) {
+	bitboard_t occupied = ~position->empty;
+	for (int color = 0; color < 2; color++) {
+		attacks[color] = EMPTY_BB;
+		bitboard_t bb = position->orthogonal[color];
+		while (bb)
+			attacks[color] |= rook_attacks(pop_lsb(&bb), occupied);
+		bb = position->diagonal[color];
+		while (bb)
+			attacks[color] |= bishop_attacks(pop_lsb(&bb), occupied);
+	}
+}
+
+
+static bitboard_t bench_random (void) {
+	static bitboard_t state = 88172645463325252ULL;
+	state ^= state << 13;
+	state ^= state >> 7;
+	state ^= state << 17;
+	return state;
+}
@@ -0,0 +1,29 @@
+#include <string.h>
+#include <time.h>
+
+#include "cli_util.h"
+
+
+// move in from-to form as used by other engines' divide, e.g. e2e4 or a7a8q, "none" for NULL_MOVE
+void move_to_string (move_t move, char *str) {
+	if (move == NULL_MOVE) {
+		strcpy(str, "none");
+		return;
+	}
+
+	int from = move_from(move), to = move_to(move), k = 0;
+	str[k++] = 'a' + square_col(from);
+	str[k++] = '1' + square_row(from);
+	str[k++] = 'a' + square_col(to);
+	str[k++] = '1' + square_row(to);
+	if (is_promotion(move))
+		str[k++] = PIECES[ASCII][1][piece_index(promotion_face(move))];
+	str[k] = '\0';
+}
+
+
+double elapsed_secs (const struct timespec *start) {
+	struct timespec end;
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	return (end.tv_sec - start->tv_sec) + (end.tv_nsec - start->tv_nsec) / 1e9;
+}
@@ -0,0 +1,13 @@
+#ifndef CLI_UTIL_H
+#define CLI_UTIL_H
+
+#include <time.h>
+
+#include "../core/chess_engine.h"
+
+#define	START_FEN	"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1"
+
+void	move_to_string	(move_t move, char *str);
+double	elapsed_secs	(const struct timespec *start);
+
+#endif
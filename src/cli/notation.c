@@ -0,0 +1,83 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "notation.h"
+#include "../core/board.h"
+#include "../core/chess_engine.h"
+#include "../core/history.h"
+#include "../core/zobrist.h"
+
+typedef struct {
+	const char	*name;
+	const char	*fen;
+	const char	*move;		// in from-to form, e.g. e2e4 or a7a8q
+	const char	*notation;	// expected in the move list and pgn exports
+} notation_position_t;
+
+// moves whose notation is easy to get wrong
+static const notation_position_t NOTATION_SUITE[] = {
+	{ "promotion",		"4k3/P7/8/8/8/8/8/4K3 w - - 0 1",	"a7a8q",	"a8=Q+" },
+	{ "black capture",	"4k3/8/8/8/8/8/4p3/3RK3 b - - 0 1",	"e2d1q",	"exd1=Q+" },
+	{ "black under",	"4k3/8/8/8/8/8/p7/4K3 b - - 0 1",	"a2a1n",	"a1=N" },
+};
+#define	NOTATION_SUITE_SIZE	((int) (sizeof(NOTATION_SUITE) / sizeof(NOTATION_SUITE[0])))
+
+static	move_t	find_move	(const board_t *board, const char *str);
+
+
+/*
+ *	chess-cli notation
+ *
+ *	plays moves of a set of positions into a game history and checks the notation recorded for them, exits with failure on mismatch.
+ */
+int run_notation (void) {
+	init_bitboards();
+	init_zobrist();
+
+	player_t plr1, plr2;
+	init_player(&plr1, "white", HUMAN);
+	init_player(&plr2, "black", HUMAN);
+
+	int status = EXIT_SUCCESS;
+	printf("%-14s %8s %10s %8s\n", "position", "move", "notation", "check");
+	for (int k = 0; k < NOTATION_SUITE_SIZE; k++) {
+		const notation_position_t *position = &NOTATION_SUITE[k];
+		board_t board;
+		move_t move;
+		if (!load_fen(&board, position->fen) || (move = find_move(&board, position->move)) == NULL_MOVE) {
+			printf("%-14s %8s\n", position->name, "bad test");
+			status = EXIT_FAILURE;
+			continue;
+		}
+
+		history_t *history = create_history(plr1, plr2, -1);
+		play_move(&board, move, history);
+		const char *notation = peek_move(history, 0);
+		bool is_ok = (strcmp(notation, position->notation) == 0);
+		if (!is_ok)
+			status = EXIT_FAILURE;
+		printf("%-14s %8s %10s %8s\n", position->name, position->move, notation, (is_ok ? "ok": "MISMATCH"));
+		delete_history(history);
+	}
+	return status;
+}
+
+
+/* legal move of board written in from-to form, NULL_MOVE if there is none */
+static move_t find_move (const board_t *board, const char *str) {
+	if (strlen(str) < 4)
+		return NULL_MOVE;
+	int from = square_of(str[1] - '1', str[0] - 'a'), to = square_of(str[3] - '1', str[2] - 'a');
+
+	movelist_t list;
+	generate_moves(board, &list);
+	for (int i = 0; i < list.count; i++) {
+		move_t move = list.moves[i];
+		if (move_from(move) != from || move_to(move) != to)
+			continue;
+		if (!is_promotion(move) || (str[4] != '\0' && str[4] == PIECES[ASCII][1][piece_index(promotion_face(move))]))
+			return move;
+	}
+	return NULL_MOVE;
+}
@@ -0,0 +1,6 @@
+#ifndef NOTATION_H
+#define NOTATION_H
+
+int		run_notation	(void);
+
+#endif
@@ -0,0 +1,291 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+#include "perft.h"
+#include "cli_util.h"
+#include "../core/board.h"
+#include "../core/chess_engine.h"
+#include "../core/zobrist.h"
+
+#define	MAX_PERFT_DEPTH		15	// depth is kept in low 4 bits of a hash entry
+#define	MAX_PERFT_THREADS	64
+
+typedef struct {
+	const char	*name;
+	const char	*fen;
+	int			depth;
+	uint64_t	nodes;
+} perft_position_t;
+
+/* lock is key ^ data, a torn write by another thread fails the check instead of giving a wrong count */
+typedef struct {
+	_Atomic uint64_t lock;	// halves are atomic on their own, relaxed as in the search's table
+	_Atomic uint64_t data;	// nodes << 4 | depth
+} perft_entry_t;
+
+typedef struct {
+	perft_entry_t *entries;
+	uint64_t mask;	// no. of entries - 1
+} perft_hash_t;
+
+/* root moves are shared by all threads, each takes the next move not taken yet */
+typedef struct {
+	const board_t *board;
+	movelist_t root_moves;
+	uint64_t nodes[MAX_GAME_MOVES];
+	int depth;
+	int next;
+	pthread_mutex_t lock;
+	perft_hash_t *hash;
+} perft_job_t;
+
+// well known positions with their node counts, from chessprogramming wiki
+static const perft_position_t PERFT_SUITE[] = {
+	{ "startpos",	START_FEN,	5,	4865609 },
+	{ "kiwipete",	"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",	4,	4085603 },
+	{ "position 3",	"8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",	5,	674624 },
+	{ "position 4",	"r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",	4,	422333 },
+	{ "position 5",	"rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",	4,	2103487 },
+	{ "position 6",	"r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",	4,	3894594 },
+};
+#define	PERFT_SUITE_SIZE	((int) (sizeof(PERFT_SUITE) / sizeof(PERFT_SUITE[0])))
+
+static	uint64_t	perft			(board_t *board, int depth, perft_hash_t *hash);
+static	uint64_t	perft_root		(const board_t *board, int depth, int threads, perft_hash_t *hash, perft_job_t *job);
+static	void*		perft_worker	(void *arg);
+static	int			run_suite		(int threads, perft_hash_t *hash);
+static	bool		init_perft_hash	(perft_hash_t *hash, long size_mb);
+static	void		print_usage		(void);
+
+
+/*
+ *	chess-cli perft <depth> [fen] [-t threads] [-H hash_mb]
+ *	chess-cli divide <depth> [fen] [-t threads] [-H hash_mb]
+ *	chess-cli perft suite [-t threads] [-H hash_mb]
+ *
+ *	fen is a single argument, so it has to be quoted. threads default to no. of cpus and hash is off by default.
+ */
+int run_perft (int argc, char **argv) {
+	bool is_divide = (strcmp(argv[1], "divide") == 0);
+	const char *positional[2] = { NULL, NULL };
+	int positionals = 0;
+	long threads = sysconf(_SC_NPROCESSORS_ONLN), hash_mb = 0;
+
+	for (int i = 2; i < argc; i++) {
+		if (strcmp(argv[i], "-t") == 0 && i+1 < argc)
+			threads = atol(argv[++i]);
+		else if (strcmp(argv[i], "-H") == 0 && i+1 < argc)
+			hash_mb = atol(argv[++i]);
+		else if (positionals < 2)
+			positional[positionals++] = argv[i];
+		else {
+			print_usage();
+			return EXIT_FAILURE;
+		}
+	}
+	if (positional[0] == NULL || threads < 1 || hash_mb < 0) {
+		print_usage();
+		return EXIT_FAILURE;
+	}
+	if (threads > MAX_PERFT_THREADS)
+		threads = MAX_PERFT_THREADS;
+
+	init_bitboards();
+	init_zobrist();
+
+	perft_hash_t hash = { NULL, 0 };
+	if (hash_mb > 0 && !init_perft_hash(&hash, hash_mb)) {
+		fprintf(stderr, "couldn't allocate memory for perft hash\n");
+		return EXIT_FAILURE;
+	}
+
+	int status = EXIT_SUCCESS;
+	if (!is_divide && strcmp(positional[0], "suite") == 0) {
+		status = run_suite(threads, &hash);
+		free(hash.entries);
+		return status;
+	}
+
+	char *end;
+	long depth = strtol(positional[0], &end, 10);
+	board_t *board = (board_t *) calloc(1, sizeof(board_t));
+	if (*end != '\0' || depth < 0 || depth > MAX_PERFT_DEPTH || board == NULL || !load_fen(board, (positional[1] ? positional[1]: START_FEN))) {
+		if (board == NULL)
+			fprintf(stderr, "couldn't allocate memory for board\n");
+		else
+			print_usage();
+		free(board);
+		free(hash.entries);
+		return EXIT_FAILURE;
+	}
+
+	perft_job_t job;
+	struct timespec start;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	uint64_t nodes = perft_root(board, depth, threads, &hash, &job);
+	double secs = elapsed_secs(&start);
+
+	if (is_divide && depth > 0) {
+		for (int i = 0; i < job.root_moves.count; i++) {
+			char move[6];
+			move_to_string(job.root_moves.moves[i], move);
+			printf("%-5s %llu\n", move, (unsigned long long) job.nodes[i]);
+		}
+		printf("\nmoves %d\n", job.root_moves.count);
+	}
+	printf("nodes %llu\ntime %.3f s\nnps %.0f\n", (unsigned long long) nodes, secs, nodes / (secs > 0 ? secs: 1e-9));
+
+	delete_board(board);
+	free(hash.entries);
+	return status;
+}
+
+
+/* leaf moves are counted from the move list, not made */
+static uint64_t perft (board_t *board, int depth, perft_hash_t *hash) {
+	if (depth == 0)
+		return 1;
+
+	perft_entry_t *entry = NULL;
+	if (hash->entries && depth > 1) {
+		entry = &hash->entries[board->key & hash->mask];
+		uint64_t data = atomic_load_explicit(&entry->data, memory_order_relaxed);
+		if ((atomic_load_explicit(&entry->lock, memory_order_relaxed) ^ data) == board->key && (int) (data & 15) == depth)
+			return data >> 4;
+	}
+
+	movelist_t list;
+	generate_moves(board, &list);
+	if (depth == 1)
+		return list.count;
+
+	uint64_t nodes = 0;
+	for (int i = 0; i < list.count; i++) {
+		undo_t undo;
+		make_move(board, list.moves[i], &undo);
+		nodes += perft(board, depth-1, hash);
+		unmake_move(board, list.moves[i], &undo);
+	}
+
+	if (entry) {
+		uint64_t data = (nodes << 4) | depth;
+		atomic_store_explicit(&entry->data, data, memory_order_relaxed);
+		atomic_store_explicit(&entry->lock, board->key ^ data, memory_order_relaxed);
+	}
+	return nodes;
+}
+
+
+/* splits root moves between threads, job keeps the root moves and node count of each for divide */
+static uint64_t perft_root (const board_t *board, int depth, int threads, perft_hash_t *hash, perft_job_t *job) {
+	job->board = board;
+	job->depth = depth;
+	job->next = 0;
+	job->hash = hash;
+	generate_moves(board, &job->root_moves);
+	if (depth == 0) {
+		job->root_moves.count = 0;
+		return 1;
+	}
+
+	pthread_mutex_init(&job->lock, NULL);
+	pthread_t workers[MAX_PERFT_THREADS];
+	int started = 0;
+	for (int i = 0; i < threads && i < job->root_moves.count; i++) {
+		if (pthread_create(&workers[i], NULL, perft_worker, (void *) job) != 0)
+			break;
+		started++;
+	}
+	// no thread could be started, do it on this one
+	if (started == 0)
+		perft_worker((void *) job);
+	for (int i = 0; i < started; i++)
+		pthread_join(workers[i], NULL);
+	pthread_mutex_destroy(&job->lock);
+
+	uint64_t nodes = 0;
+	for (int i = 0; i < job->root_moves.count; i++)
+		nodes += job->nodes[i];
+	return nodes;
+}
+
+
+static void* perft_worker (void *arg) {
+	perft_job_t *job = (perft_job_t *) arg;
+	board_t board;
+	copy_board(&board, job->board);
+
+	while (true) {
+		pthread_mutex_lock(&job->lock);
+		int i = job->next++;
+		pthread_mutex_unlock(&job->lock);
+		if (i >= job->root_moves.count)
+			break;
+
+		undo_t undo;
+		make_move(&board, job->root_moves.moves[i], &undo);
+		job->nodes[i] = perft(&board, job->depth-1, job->hash);
+		unmake_move(&board, job->root_moves.moves[i], &undo);
+	}
+
+	return NULL;
+}
+
+
+static int run_suite (int threads, perft_hash_t *hash) {
+	int status = EXIT_SUCCESS;
+	uint64_t total_nodes = 0;
+	struct timespec suite_start;
+	clock_gettime(CLOCK_MONOTONIC, &suite_start);
+
+	printf("%-12s %6s %12s %10s %12s %8s\n", "position", "depth", "nodes", "time", "nps", "check");
+	for (int k = 0; k < PERFT_SUITE_SIZE; k++) {
+		const perft_position_t *position = &PERFT_SUITE[k];
+		board_t board;
+		if (!load_fen(&board, position->fen)) {
+			printf("%-12s %6s\n", position->name, "bad fen");
+			status = EXIT_FAILURE;
+			continue;
+		}
+
+		perft_job_t job;
+		struct timespec start;
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		uint64_t nodes = perft_root(&board, position->depth, threads, hash, &job);
+		double secs = elapsed_secs(&start);
+		total_nodes += nodes;
+
+		bool is_ok = (nodes == position->nodes);
+		if (!is_ok)
+			status = EXIT_FAILURE;
+		printf("%-12s %6d %12llu %9.3fs %12.0f %8s\n", position->name, position->depth, (unsigned long long) nodes, secs, nodes / (secs > 0 ? secs: 1e-9), (is_ok ? "ok": "MISMATCH"));
+	}
+
+	double secs = elapsed_secs(&suite_start);
+	printf("total %llu nodes in %.3f s, %.0f nps\n", (unsigned long long) total_nodes, secs, total_nodes / (secs > 0 ? secs: 1e-9));
+	return status;
+}
+
+
+/* size is rounded down to a power of two entries */
+static bool init_perft_hash (perft_hash_t *hash, long size_mb) {
+	uint64_t entries = 1;
+	while (entries * 2 * sizeof(perft_entry_t) <= (uint64_t) size_mb << 20)
+		entries *= 2;
+
+	hash->entries = (perft_entry_t *) calloc(entries, sizeof(perft_entry_t));
+	hash->mask = entries - 1;
+	return (hash->entries != NULL);
+}
+
+
+static void print_usage (void) {
+	fprintf(stderr, "usage: chess-cli perft <depth> [fen] [-t threads] [-H hash_mb]\n");
+	fprintf(stderr, "       chess-cli divide <depth> [fen] [-t threads] [-H hash_mb]\n");
+	fprintf(stderr, "       chess-cli perft suite [-t threads] [-H hash_mb]\n");
+}
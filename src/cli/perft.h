@@ -0,0 +1,6 @@
+#ifndef PERFT_H
+#define PERFT_H
+
+int		run_perft	(int argc, char **argv);
+
+#endif
@@ -0,0 +1,180 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "search.h"
+#include "cli_util.h"
+#include "../core/board.h"
+#include "../core/chess_engine.h"
+#include "../core/zobrist.h"
+#include "../ai/minimax_ab.h"
+#include "../ai/eval_funcs.h"
+#include "../ai/tt.h"
+
+typedef struct {
+	const char		*name;
+	const char		*fen;
+	int				depth;
+	const char		*move;	// expected best move, "" when several are equally good
+	board_value_t	board_value;	// expected score, from white's point of view
+} search_position_t;
+
+// positions whose result search has to get exactly, mates and stalemates are scored apart from the static eval, exchanges runs
+// long chains of captures and evasions through quiescence
+static const search_position_t SEARCH_SUITE[] = {
+	{ "mate in 1",	"6k1/5ppp/8/8/8/8/8/R5K1 w - - 0 1",	4,	"a1a8",	MATE_BOARD_VALUE - 1 },
+	{ "mate in 2",	"k7/8/2K5/8/8/8/8/7R w - - 0 1",	5,	"",		MATE_BOARD_VALUE - 3 },
+	{ "mated",		"R5k1/5ppp/8/8/8/8/8/6K1 b - - 0 1",	4,	"none",	MATE_BOARD_VALUE },
+	{ "stalemate",	"7k/5Q2/6K1/8/8/8/8/8 b - - 0 1",	4,	"none",	DRAW_BOARD_VALUE },
+	{ "exchanges",	"7k/pr4pp/q1nb1r2/1PBpnN2/2B1p1n1/1Q1NRb2/P1P2qPP/4R1K1 w - - 0 1",	4,	"d3f2",	-4 },
+};
+#define	SEARCH_SUITE_SIZE	((int) (sizeof(SEARCH_SUITE) / sizeof(SEARCH_SUITE[0])))
+
+static	int		run_suite		(int pruning);
+static	void	print_usage		(void);
+static	bool	parse_pruning	(const char *arg, int *pruning);
+
+
+/*
+ *	chess-cli search <depth> [fen] [-H hash_mb] [-T clock_secs] [-P pruning] [-t threads]
+ *	chess-cli search suite [-H hash_mb] [-P pruning] [-t threads]
+ *
+ *	runs the AI search on the position (initial position by default) and reports best move, nodes and transposition table use.
+ *	with -T the side to move has clock_secs left on its clock and search manages its time as in a timed game.
+ *	-P picks the selective search techniques, comma separated from null, lmr and futility, or all (default) or none.
+ *	threads search together sharing the transposition table, 1 by default.
+ *	suite searches a set of positions with known best move and score, exits with failure on mismatch.
+ */
+int run_search (int argc, char **argv) {
+	const char *positional[2] = { NULL, NULL };
+	int positionals = 0;
+	long hash_mb = DEFAULT_TT_MB;
+	long clock_secs = -1;
+	int pruning = ALL_PRUNING;
+	long threads = 1;
+
+	for (int i = 2; i < argc; i++) {
+		if (strcmp(argv[i], "-H") == 0 && i+1 < argc)
+			hash_mb = atol(argv[++i]);
+		else if (strcmp(argv[i], "-t") == 0 && i+1 < argc)
+			threads = atol(argv[++i]);
+		else if (strcmp(argv[i], "-T") == 0 && i+1 < argc)
+			clock_secs = atol(argv[++i]);
+		else if (strcmp(argv[i], "-P") == 0 && i+1 < argc) {
+			if (!parse_pruning(argv[++i], &pruning)) {
+				print_usage();
+				return EXIT_FAILURE;
+			}
+		}
+		else if (positionals < 2)
+			positional[positionals++] = argv[i];
+		else {
+			print_usage();
+			return EXIT_FAILURE;
+		}
+	}
+
+	bool is_suite = (positional[0] && strcmp(positional[0], "suite") == 0);
+	char *end = NULL;
+	long depth = (positional[0] && !is_suite ? strtol(positional[0], &end, 10): 1);
+	if (positional[0] == NULL || (end && *end != '\0') || depth < 1 || depth > MAX_AI_DEPTH * 2 || hash_mb < 0 || threads < 1 || (is_suite && positional[1])) {
+		print_usage();
+		return EXIT_FAILURE;
+	}
+
+	init_bitboards();
+	init_zobrist();
+	if (hash_mb > 0 && !init_tt(hash_mb)) {
+		fprintf(stderr, "couldn't allocate memory for transposition table\n");
+		return EXIT_FAILURE;
+	}
+
+	set_search_threads(threads);
+	if (is_suite)
+		return run_suite(pruning);
+
+	board_t board;
+	if (!load_fen(&board, (positional[1] ? positional[1]: START_FEN))) {
+		print_usage();
+		return EXIT_FAILURE;
+	}
+
+	if (clock_secs >= 0)
+		board.plr_times[0] = board.plr_times[1] = clock_secs;
+
+	minimax_ab_ai_t ai = { depth, piece_value_based_static_eval, pruning };
+	search_result_t result;
+	struct timespec start;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	minimax_ab_search(&board, NULL, ai, &result);
+	double secs = elapsed_secs(&start);
+
+	char move[6];
+	move_to_string(result.move, move);
+
+	tt_stats_t stats = get_tt_stats();
+	printf("bestmove %s\nscore %d\ndepth %d\nthreads %d\nnodes %lld\ntime %.3f s\nnps %.0f\n", move, result.board_value, result.depth, result.threads, result.nodes, secs, result.nodes / (secs > 0 ? secs: 1e-9));
+	printf("cutoffs %lld, on first move %.1f%%, aspiration re-searches %lld\n", result.cutoffs, (result.cutoffs ? 100.0 * result.first_move_cutoffs / result.cutoffs: 0), result.researches);
+	printf("tt %zu MB, probes %llu, hits %llu (%.1f%%), stores %llu, collisions %llu\n", get_tt_size_mb(), (unsigned long long) stats.probes, (unsigned long long) stats.hits,
+			(stats.probes ? 100.0 * stats.hits / stats.probes: 0), (unsigned long long) stats.stores, (unsigned long long) stats.collisions);
+
+	return EXIT_SUCCESS;
+}
+
+
+static int run_suite (int pruning) {
+	int status = EXIT_SUCCESS;
+	printf("%-12s %6s %8s %8s %10s %8s\n", "position", "depth", "move", "score", "time", "check");
+	for (int k = 0; k < SEARCH_SUITE_SIZE; k++) {
+		const search_position_t *position = &SEARCH_SUITE[k];
+		board_t board;
+		if (!load_fen(&board, position->fen)) {
+			printf("%-12s %6s\n", position->name, "bad fen");
+			status = EXIT_FAILURE;
+			continue;
+		}
+
+		// each position is searched afresh, as in a new game
+		clear_tt();
+		minimax_ab_ai_t ai = { position->depth, piece_value_based_static_eval, pruning };
+		search_result_t result;
+		struct timespec start;
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		minimax_ab_search(&board, NULL, ai, &result);
+		double secs = elapsed_secs(&start);
+
+		char move[6];
+		move_to_string(result.move, move);
+		bool is_ok = ((position->move[0] == '\0' || strcmp(move, position->move) == 0) && result.board_value == position->board_value);
+		if (!is_ok)
+			status = EXIT_FAILURE;
+		printf("%-12s %6d %8s %8d %9.3fs %8s\n", position->name, position->depth, move, result.board_value, secs, (is_ok ? "ok": "MISMATCH"));
+	}
+	return status;
+}
+
+
+static void print_usage (void) {
+	fprintf(stderr, "usage: chess-cli search <depth> [fen] [-H hash_mb] [-T clock_secs] [-P null,lmr,futility|all|none] [-t threads]\n");
+	fprintf(stderr, "       chess-cli search suite [-H hash_mb] [-P null,lmr,futility|all|none] [-t threads]\n");
+}
+
+
+static bool parse_pruning (const char *arg, int *pruning) {
+	const char *names[] = { "none", "null", "lmr", "futility", "all" };
+	const int masks[] = { 0, NULL_MOVE_PRUNING, LATE_MOVE_REDUCTIONS, FUTILITY_PRUNING, ALL_PRUNING };
+
+	*pruning = 0;
+	while (*arg) {
+		size_t len = strcspn(arg, ",");
+		size_t k = 0;
+		while (k < sizeof(masks) / sizeof(masks[0]) && (strlen(names[k]) != len || strncmp(arg, names[k], len) != 0))
+			k++;
+		if (k == sizeof(masks) / sizeof(masks[0]))
+			return false;
+		*pruning |= masks[k];
+		arg += len + (arg[len] == ',');
+	}
+	return true;
+}
@@ -0,0 +1,6 @@
+#ifndef SEARCH_H
+#define SEARCH_H
+
+int		run_search	(int argc, char **argv);
+
+#endif
@@ -0,0 +1,94 @@
+#include <string.h>
+
+#include "attack_map.h"
+
+static	face_t	face_at			(const board_t *board, int sq);
+static	void	add_attacks		(board_t *board, int sq, int delta);
+
+
+/* rebuild attacker counts and attack masks from scratch */
+void init_attack_map (board_t *board) {
+	memset(board->attackers, 0, sizeof(board->attackers));
+	memset(board->attacks, 0, sizeof(board->attacks));
+	bitboard_t occupied = occupancy(board);
+	while (occupied)
+		add_attacks(board, pop_lsb(&occupied), 1);
+}
+
+
+/*
+ * Incremental update is done in two steps around a change of pieces on the squares in changed:
+ *
+ *	bitboard_t touched = detach_attacks(board, changed);
+ *	... place/remove pieces on changed squares ...
+ *	attach_attacks(board, touched);
+ *
+ * Only attacks of pieces on changed squares and of sliders whose rays reach a changed square can change,
+ * detach removes their attacks with the old occupancy and attach adds them back with the new one.
+ */
+bitboard_t detach_attacks (board_t *board, bitboard_t changed) {
+	bitboard_t occupied = occupancy(board);
+	bitboard_t orthogonal = EMPTY_BB, diagonal = EMPTY_BB;
+	for (int color = 0; color < 2; color++) {
+		orthogonal |= board->pieces[color][piece_index(ROOK)] | board->pieces[color][piece_index(QUEEN)];
+		diagonal |= board->pieces[color][piece_index(BISHOP)] | board->pieces[color][piece_index(QUEEN)];
+	}
+
+	bitboard_t touched = changed;
+	for (bitboard_t bb = changed; bb; ) {
+		int sq = pop_lsb(&bb);
+		touched |= (rook_attacks(sq, occupied) & orthogonal) | (bishop_attacks(sq, occupied) & diagonal);
+	}
+
+	for (bitboard_t bb = touched & occupied; bb; )
+		add_attacks(board, pop_lsb(&bb), -1);
+
+	return touched;
+}
+
+
+void attach_attacks (board_t *board, bitboard_t squares) {
+	for (bitboard_t bb = squares & occupancy(board); bb; )
+		add_attacks(board, pop_lsb(&bb), 1);
+}
+
+
+/* squares attacked by the piece with face standing on sq, with current occupancy of the board */
+bitboard_t piece_attacks (const board_t *board, int sq, face_t face) {
+	switch (face & ~COLOR_BIT) {
+		case KING:
+			return KING_ATTACKS[sq];
+		case QUEEN:
+			return queen_attacks(sq, occupancy(board));
+		case ROOK:
+			return rook_attacks(sq, occupancy(board));
+		case BISHOP:
+			return bishop_attacks(sq, occupancy(board));
+		case KNIGHT:
+			return KNIGHT_ATTACKS[sq];
+		case PAWN:
+			return PAWN_ATTACKS[color_index(face)][sq];
+	}
+	return EMPTY_BB;
+}
+
+
+static face_t face_at (const board_t *board, int sq) {
+	return board->tiles[square_row(sq)][square_col(sq)].piece.face;
+}
+
+
+static void add_attacks (board_t *board, int sq, int delta) {
+	face_t face = face_at(board, sq);
+	color_t color = color_index(face);
+	uint8_t *attackers = board->attackers[color];
+	bitboard_t attacks = piece_attacks(board, sq, face);
+	while (attacks) {
+		int target = pop_lsb(&attacks);
+		attackers[target] += delta;
+		if (attackers[target] == 0)
+			board->attacks[color] &= ~square_bb(target);
+		else
+			board->attacks[color] |= square_bb(target);
+	}
+}
@@ -0,0 +1,14 @@
+#ifndef ATTACK_MAP_H
+#define ATTACK_MAP_H
+
+#include "board.h"
+
+#define attackers_of(b, sq, color)	((b)->attackers[color][sq])	// no. of pieces of color attacking sq
+
+
+void		init_attack_map		(board_t *board);
+bitboard_t	detach_attacks		(board_t *board, bitboard_t changed);
+void		attach_attacks		(board_t *board, bitboard_t squares);
+bitboard_t	piece_attacks		(const board_t *board, int sq, face_t face);
+
+#endif
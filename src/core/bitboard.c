@@ -0,0 +1,224 @@
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#define HAS_PEXT_KERNEL	1
+#else
+#define HAS_PEXT_KERNEL	0
+#endif
+
+#include "bitboard.h"
+#include "setwise.h"
+
+#define	ROOK_TABLE_SIZE		102400	// sum of 2^(relevant occupancy bits) over all squares
+#define	BISHOP_TABLE_SIZE	5248
+
+typedef struct {
+	bitboard_t	mask;		// relevant occupancy, edges excluded
+	bitboard_t	magic;
+	int			shift;
+	bitboard_t	*magic_attacks;
+	bitboard_t	*pext_attacks;
+} slider_entry_t;
+
+const	char*	SLIDER_KERNEL_NAMES[SLIDER_KERNELS]	=	{ "walk", "magic", "pext" };
+
+static	const	short	ROOK_DIRECTIONS[4][2]	=	{ {-1, 0}, {1, 0}, {0, -1}, {0, 1} };
+static	const	short	BISHOP_DIRECTIONS[4][2]	=	{ {-1, -1}, {1, 1}, {-1, 1}, {1, -1} };
+
+static	slider_entry_t	ROOK_ENTRIES[64];
+static	slider_entry_t	BISHOP_ENTRIES[64];
+static	bitboard_t		ROOK_MAGIC_TABLE[ROOK_TABLE_SIZE];
+static	bitboard_t		BISHOP_MAGIC_TABLE[BISHOP_TABLE_SIZE];
+static	bitboard_t		ROOK_PEXT_TABLE[ROOK_TABLE_SIZE];
+static	bitboard_t		BISHOP_PEXT_TABLE[BISHOP_TABLE_SIZE];
+
+static	enum slider_kernel	slider_kernel	=	WALK_KERNEL;
+static	bitboard_t			(*rook_kernel)(int sq, bitboard_t occupied);
+static	bitboard_t			(*bishop_kernel)(int sq, bitboard_t occupied);
+
+static	bitboard_t	slider_walk				(int sq, bitboard_t occupied, const short directions[4][2]);
+static	bitboard_t	rook_attacks_walk		(int sq, bitboard_t occupied);
+static	bitboard_t	bishop_attacks_walk		(int sq, bitboard_t occupied);
+static	bitboard_t	rook_attacks_magic		(int sq, bitboard_t occupied);
+static	bitboard_t	bishop_attacks_magic	(int sq, bitboard_t occupied);
+#if HAS_PEXT_KERNEL
+static	bitboard_t	rook_attacks_pext		(int sq, bitboard_t occupied);
+static	bitboard_t	bishop_attacks_pext		(int sq, bitboard_t occupied);
+#endif
+static	void		init_slider_entries		(slider_entry_t entries[64], const short directions[4][2], const bitboard_t magics[64], bitboard_t *magic_table, bitboard_t *pext_table);
+static	bitboard_t	pext					(bitboard_t occupied, bitboard_t mask);
+#if HAS_PEXT_KERNEL
+static	bool		cpu_has_bmi2			(void);
+#endif
+
+
+void init_bitboards (void) {
+	static bool is_initialized = false;
+	if (is_initialized)
+		return;
+
+	// king, knight, pawn and line tables are const, only slider attack tables are left to fill
+	init_slider_entries(ROOK_ENTRIES, ROOK_DIRECTIONS, ROOK_MAGICS, ROOK_MAGIC_TABLE, ROOK_PEXT_TABLE);
+	init_slider_entries(BISHOP_ENTRIES, BISHOP_DIRECTIONS, BISHOP_MAGICS, BISHOP_MAGIC_TABLE, BISHOP_PEXT_TABLE);
+
+	if (!set_slider_kernel(PEXT_KERNEL))
+		set_slider_kernel(MAGIC_KERNEL);
+	init_setwise();
+
+	is_initialized = true;
+}
+
+
+bitboard_t rook_attacks (int sq, bitboard_t occupied) {
+	return rook_kernel(sq, occupied);
+}
+
+
+bitboard_t bishop_attacks (int sq, bitboard_t occupied) {
+	return bishop_kernel(sq, occupied);
+}
+
+
+bitboard_t queen_attacks (int sq, bitboard_t occupied) {
+	return rook_kernel(sq, occupied) | bishop_kernel(sq, occupied);
+}
+
+
+/* returns false (and keeps the current kernel) if the kernel isn't supported by this cpu or build */
+bool set_slider_kernel (enum slider_kernel kernel) {
+	switch (kernel) {
+		case WALK_KERNEL:
+			rook_kernel = rook_attacks_walk;
+			bishop_kernel = bishop_attacks_walk;
+			break;
+		case MAGIC_KERNEL:
+			rook_kernel = rook_attacks_magic;
+			bishop_kernel = bishop_attacks_magic;
+			break;
+#if HAS_PEXT_KERNEL
+		case PEXT_KERNEL:
+			if (!cpu_has_bmi2())
+				return false;
+			rook_kernel = rook_attacks_pext;
+			bishop_kernel = bishop_attacks_pext;
+			break;
+#endif
+		default:
+			return false;
+	}
+	slider_kernel = kernel;
+	return true;
+}
+
+
+enum slider_kernel get_slider_kernel (void) {
+	return slider_kernel;
+}
+
+
+/* attacked squares include the first blocker in each direction irrespective of its color, callers mask out own pieces */
+static bitboard_t slider_walk (int sq, bitboard_t occupied, const short directions[4][2]) {
+	bitboard_t bb = EMPTY_BB;
+	short row = square_row(sq), col = square_col(sq);
+	for (int k = 0; k < 4; k++) {
+		for (short i = row + directions[k][0], j = col + directions[k][1]; i >= 0 && i < 8 && j >= 0 && j < 8; i += directions[k][0], j += directions[k][1]) {
+			bb |= square_bb(square_of(i, j));
+			if (occupied & square_bb(square_of(i, j)))
+				break;
+		}
+	}
+	return bb;
+}
+
+
+static bitboard_t rook_attacks_walk (int sq, bitboard_t occupied) {
+	return slider_walk(sq, occupied, ROOK_DIRECTIONS);
+}
+
+
+static bitboard_t bishop_attacks_walk (int sq, bitboard_t occupied) {
+	return slider_walk(sq, occupied, BISHOP_DIRECTIONS);
+}
+
+
+static bitboard_t rook_attacks_magic (int sq, bitboard_t occupied) {
+	const slider_entry_t *entry = &ROOK_ENTRIES[sq];
+	return entry->magic_attacks[((occupied & entry->mask) * entry->magic) >> entry->shift];
+}
+
+
+static bitboard_t bishop_attacks_magic (int sq, bitboard_t occupied) {
+	const slider_entry_t *entry = &BISHOP_ENTRIES[sq];
+	return entry->magic_attacks[((occupied & entry->mask) * entry->magic) >> entry->shift];
+}
+
+
+#if HAS_PEXT_KERNEL
+/* compiled for BMI2 only, set_slider_kernel selects these after checking the cpu */
+__attribute__((target("bmi2")))
+static bitboard_t rook_attacks_pext (int sq, bitboard_t occupied) {
+	const slider_entry_t *entry = &ROOK_ENTRIES[sq];
+	return entry->pext_attacks[_pext_u64(occupied, entry->mask)];
+}
+
+
+__attribute__((target("bmi2")))
+static bitboard_t bishop_attacks_pext (int sq, bitboard_t occupied) {
+	const slider_entry_t *entry = &BISHOP_ENTRIES[sq];
+	return entry->pext_attacks[_pext_u64(occupied, entry->mask)];
+}
+#endif
+
+
+/* fills both magic and pext tables, every square gets a slice of 2^bits entries of each table. masks must match the ones tools/gen_tables.c found magics for */
+static void init_slider_entries (slider_entry_t entries[64], const short directions[4][2], const bitboard_t magics[64], bitboard_t *magic_table, bitboard_t *pext_table) {
+	static bitboard_t occupancies[4096], attacks[4096];
+	int offset = 0;
+
+	for (int sq = 0; sq < 64; sq++) {
+		slider_entry_t *entry = &entries[sq];
+		// edge squares don't change the attack set unless the slider is on that edge
+		bitboard_t edges = ((ROW_1_BB | ROW_8_BB) & ~row_bb(square_row(sq))) | ((FILE_A_BB | FILE_H_BB) & ~col_bb(square_col(sq)));
+		entry->mask = slider_walk(sq, EMPTY_BB, directions) & ~edges;
+		int bits = bb_popcount(entry->mask);
+		int size = 0;
+
+		// enumerate all subsets of mask (carry-rippler)
+		bitboard_t subset = EMPTY_BB;
+		do {
+			occupancies[size] = subset;
+			attacks[size] = slider_walk(sq, subset, directions);
+			size++;
+			subset = (subset - entry->mask) & entry->mask;
+		} while (subset);
+
+		entry->shift = 64 - bits;
+		entry->magic_attacks = magic_table + offset;
+		entry->pext_attacks = pext_table + offset;
+		entry->magic = magics[sq];
+		for (int k = 0; k < size; k++) {
+			entry->magic_attacks[(occupancies[k] * entry->magic) >> entry->shift] = attacks[k];
+			entry->pext_attacks[pext(occupancies[k], entry->mask)] = attacks[k];
+		}
+		offset += size;
+	}
+}
+
+
+/* portable parallel bits extract, used to fill the pext tables */
+static bitboard_t pext (bitboard_t occupied, bitboard_t mask) {
+	bitboard_t result = EMPTY_BB;
+	for (bitboard_t bit = 1; mask; bit <<= 1) {
+		if (occupied & mask & -mask)
+			result |= bit;
+		mask &= mask - 1;
+	}
+	return result;
+}
+
+
+#if HAS_PEXT_KERNEL
+static bool cpu_has_bmi2 (void) {
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("bmi2");
+}
+#endif
@@ -0,0 +1,58 @@
+#ifndef BITBOARD_H
+#define BITBOARD_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* squares are numbered from (0, 0) tile to (7, 7) tile i.e. square = row * 8 + col, A1 = 0, H1 = 7, A8 = 56 */
+#define square_of(row, col)	((row) * 8 + (col))
+#define square_row(sq)		((sq) >> 3)
+#define square_col(sq)		((sq) & 7)
+#define square_bb(sq)		(1ULL << (sq))
+#define NO_SQUARE			-1
+
+#define EMPTY_BB			0ULL
+#define FILE_A_BB			0x0101010101010101ULL
+#define FILE_H_BB			0x8080808080808080ULL
+#define ROW_1_BB			0x00000000000000FFULL
+#define ROW_8_BB			0xFF00000000000000ULL
+#define row_bb(row)			(ROW_1_BB << (8 * (row)))
+#define col_bb(col)			(FILE_A_BB << (col))
+
+#define bb_popcount(bb)		__builtin_popcountll(bb)
+#define bb_lsb(bb)			__builtin_ctzll(bb)
+
+typedef	uint64_t	bitboard_t;
+
+/* rook, bishop and queen attacks are looked up through one of these kernels, init_bitboards picks PEXT_KERNEL on cpus with BMI2 and MAGIC_KERNEL otherwise */
+enum	slider_kernel	{ WALK_KERNEL, MAGIC_KERNEL, PEXT_KERNEL, SLIDER_KERNELS };
+
+extern	const	char*	SLIDER_KERNEL_NAMES[SLIDER_KERNELS];
+
+
+/* geometry tables are generated at build time by tools/gen_tables.c */
+extern	const	bitboard_t	KING_ATTACKS[64];
+extern	const	bitboard_t	KNIGHT_ATTACKS[64];
+extern	const	bitboard_t	PAWN_ATTACKS[2][64];		// indexed by color (0 for WHITE, 1 for BLACK)
+extern	const	bitboard_t	BETWEEN[64][64];			// squares strictly between two squares on a line or diagonal
+extern	const	bitboard_t	LINE[64][64];				// whole line or diagonal through two squares, including both
+extern	const	bitboard_t	ROOK_MAGICS[64];			// multipliers indexing the magic attack tables filled by init_bitboards
+extern	const	bitboard_t	BISHOP_MAGICS[64];
+
+
+void		init_bitboards		(void);
+bitboard_t	rook_attacks		(int sq, bitboard_t occupied);
+bitboard_t	bishop_attacks		(int sq, bitboard_t occupied);
+bitboard_t	queen_attacks		(int sq, bitboard_t occupied);
+bool		set_slider_kernel	(enum slider_kernel kernel);
+enum slider_kernel	get_slider_kernel	(void);
+
+
+// remove and return the least significant square of the bitboard
+static inline int pop_lsb (bitboard_t *bb) {
+	int sq = bb_lsb(*bb);
+	*bb &= *bb - 1;
+	return sq;
+}
+
+#endif
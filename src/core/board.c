@@ -2,6 +2,8 @@
 #include <stdlib.h>
 
 #include "board.h"
+#include "attack_map.h"
+#include "zobrist.h"
 
 const wchar_t PIECES[2][2][6] = {
 	{
@@ -17,11 +19,11 @@ const wchar_t PIECES[2][2][6] = {
 bool	SETTINGS_UNICODE_MODE	=	true;
 
 
-static	piece_t*	init_piece	(short i, short j);
+static	piece_t		init_piece	(short i, short j);
 
 
 wchar_t get_piece_face(const piece_t *piece) {
-	if (piece == NULL)
+	if (piece == NULL || piece->face == NO_PIECE)
 		return L' ';
 	int type = 0;
 	while (!(piece->face & (1 << type))) type++;
@@ -31,7 +33,7 @@ wchar_t get_piece_face(const piece_t *piece) {
 
 
 char get_piece_for_move_notation (const piece_t *piece) {
-	if (piece == NULL)
+	if (piece == NULL || piece->face == NO_PIECE)
 		return '\0';
 	int type = 0;
 	while (!(piece->face & (1 << type))) type++;
@@ -49,11 +51,11 @@ void init_board(board_t *board, int time_limit) {
 		}
 	}
 
-	board->kings[0] = &(board->tiles[0][4]);
-	board->kings[1] = &(board->tiles[7][4]);
-
 	board->chance = WHITE;
+	board->castling = ALL_CASTLING;
+	board->ep_square = NO_SQUARE;
 	board->result = PENDING;
+	sync_bitboards(board);
 	board->is_fake = false;
 	board->plr_times[0] = board->plr_times[1] = time_limit;
 }
@@ -63,84 +65,266 @@ void copy_board (board_t *dest_board, const board_t *src_board) {
 	if (dest_board == NULL || src_board == NULL)
 		return;
 
+	memcpy(dest_board, src_board, sizeof(board_t));
+}
+
+
+void delete_board (board_t *board) {
+	free(board);
+}
+
+
+void promote_pawn (piece_t *piece, const face_t piece_type) {
+	if (piece == NULL || !(piece->face & PAWN))
+		return;
+	piece->face ^= PAWN;
+	piece->face |= piece_type;
+}
+
+
+/* add the piece to bitboards (and key) if absent at sq, remove otherwise. NO_PIECE is ignored */
+void toggle_bitboards (board_t *board, int sq, face_t face) {
+	int type = piece_index(face);
+	if (type < 0)
+		return;
+	color_t color = color_index(face);
+	board->pieces[color][type] ^= square_bb(sq);
+	board->occupied[color] ^= square_bb(sq);
+	board->key ^= piece_key(face, sq);
+}
+
+
+/* rebuild bitboards, attack map and key from tiles */
+void sync_bitboards (board_t *board) {
+	memset(board->pieces, 0, sizeof(board->pieces));
+	memset(board->occupied, 0, sizeof(board->occupied));
 	for (short i = 0; i < 8; i++)
 		for (short j = 0; j < 8; j++)
-			if (dest_board->tiles[i][j].piece != NULL)
-				free(dest_board->tiles[i][j].piece);
+			if (!is_empty(&board->tiles[i][j]))
+				toggle_bitboards(board, square_of(i, j), board->tiles[i][j].piece.face);
+	init_attack_map(board);
+	board->key = compute_key(board);
+}
 
-	memset(dest_board, 0, sizeof(board_t));
-	memcpy(dest_board, src_board, sizeof(board_t));
-	dest_board->is_fake = src_board->is_fake;
+
+/* castling rights from unmoved kings and rooks on their initial tiles, for boards built from tiles */
+int find_castling_rights (const board_t *board) {
+	int rights = 0;
+	for (int color = 0; color < 2; color++) {
+		short row = (color ? 7: 0);
+		if (!(board->pieces[color][piece_index(KING)] & square_bb(square_of(row, 4))) || board->tiles[row][4].piece.is_moved)
+			continue;
+
+		bitboard_t rooks = board->pieces[color][piece_index(ROOK)];
+		if ((rooks & square_bb(square_of(row, 7))) && !board->tiles[row][7].piece.is_moved)
+			rights |= (color ? BLACK_KING_SIDE: WHITE_KING_SIDE);
+		if ((rooks & square_bb(square_of(row, 0))) && !board->tiles[row][0].piece.is_moved)
+			rights |= (color ? BLACK_QUEEN_SIDE: WHITE_QUEEN_SIDE);
+	}
+	return rights;
+}
+
+
+/* load position from Forsyth-Edwards Notation, fullmove number is accepted but not stored. returns false for malformed fen, board is left partially filled then and should be deleted */
+bool load_fen (board_t *board, const char *fen) {
+	static const short INITIAL_COUNT[PIECE_TYPES] = { 1, 1, 2, 2, 2, 8 };
+
+	memset(board, 0, sizeof(*board));
 	for (short i = 0; i < 8; i++) {
 		for (short j = 0; j < 8; j++) {
-			if (dest_board->tiles[i][j].piece == NULL)
-				continue;
-			dest_board->tiles[i][j].piece = (piece_t*) malloc(sizeof(piece_t));
-			memcpy(dest_board->tiles[i][j].piece, src_board->tiles[i][j].piece, sizeof(piece_t));
+			board->tiles[i][j].row = i;
+			board->tiles[i][j].col = j;
 		}
 	}
 
-	// set kings
-	for (int i = 0; i < 2; i++) {
-		const tile_t *old_king = src_board->kings[i];
-		dest_board->kings[i] = &(dest_board->tiles[old_king->row][old_king->col]);
+	// piece placement, from 8th row to 1st
+	short row = 7, col = 0;
+	const char *c = fen;
+	for (; *c != '\0' && *c != ' '; c++) {
+		if (*c == '/') {
+			if (col != 8 || row == 0)
+				return false;
+			row--;
+			col = 0;
+			continue;
+		}
+		if (*c >= '1' && *c <= '8') {
+			col += *c - '0';
+			if (col > 8)
+				return false;
+			continue;
+		}
+
+		face_t face = 0;
+		for (int color = 0; color < 2 && !face; color++)
+			for (int type = 0; type < PIECE_TYPES && !face; type++)
+				if (*c == PIECES[ASCII][color][type])
+					face = (1 << type) | (color ? BLACK: WHITE);
+		if (!face || col > 7)
+			return false;
+
+		piece_t *piece = &board->tiles[row][col].piece;
+		piece->face = face;
+		// pawns on their initial row can still double step, castling pieces are unmarked below
+		piece->is_moved = !((face & PAWN) && row == (is_black(face) ? 6: 1));
+		col++;
 	}
-}
+	if (row != 0 || col != 8)
+		return false;
 
+	// side to move
+	while (*c == ' ') c++;
+	if (*c != 'w' && *c != 'b')
+		return false;
+	board->chance = (*c++ == 'b' ? BLACK: WHITE);
 
-void delete_board (board_t *board) {
-	if (board == NULL)
-		return;
+	// castling rights, their king and rooks are the pieces never moved
+	while (*c == ' ') c++;
+	for (; *c != '\0' && *c != ' '; c++) {
+		if (*c == '-')
+			continue;
+		short rights_row = (*c == 'K' || *c == 'Q' ? 0: 7), rook_col = (*c == 'K' || *c == 'k' ? 7: 0);
+		int right = (*c == 'K' ? WHITE_KING_SIDE: *c == 'Q' ? WHITE_QUEEN_SIDE: *c == 'k' ? BLACK_KING_SIDE: *c == 'q' ? BLACK_QUEEN_SIDE: 0);
+		piece_t *king = &board->tiles[rights_row][4].piece, *rook = &board->tiles[rights_row][rook_col].piece;
+		if (!right || !(king->face & KING) || !(rook->face & ROOK) || is_black(king->face) != (rights_row == 7) || is_black(rook->face) != (rights_row == 7))
+			return false;
+		board->castling |= right;
+		king->is_moved = false;
+		rook->is_moved = false;
+	}
 
-	for (short i = 0; i < 8; i++)
-		for (short j = 0; j < 8; j++)
-			if (board->tiles[i][j].piece)
-				free(board->tiles[i][j].piece);
-	
-	free(board);
+	// en passant square
+	while (*c == ' ') c++;
+	board->ep_square = NO_SQUARE;
+	if (*c >= 'a' && *c <= 'h' && (c[1] == '3' || c[1] == '6')) {
+		board->ep_square = square_of(c[1] - '1', *c - 'a');
+		c += 2;
+	} else if (*c == '-') {
+		c++;
+	} else if (*c != '\0') {
+		return false;
+	}
+
+	// halfmove clock, optional
+	while (*c == ' ') c++;
+	board->halfmove_clock = 0;
+	for (; *c >= '0' && *c <= '9'; c++) {
+		board->halfmove_clock = board->halfmove_clock * 10 + (*c - '0');
+		if (board->halfmove_clock > FIFTY_MOVE_PLIES)
+			board->halfmove_clock = FIFTY_MOVE_PLIES;
+	}
+
+	board->result = PENDING;
+	board->is_fake = false;
+	board->plr_times[0] = board->plr_times[1] = -1;
+	sync_bitboards(board);
+	if (bb_popcount(board->pieces[0][piece_index(KING)]) != 1 || bb_popcount(board->pieces[1][piece_index(KING)]) != 1)
+		return false;
+
+	// pieces missing from initial set are shown as captured, promotions can make up for them
+	for (int color = 0; color < 2; color++) {
+		for (int type = 0; type < PIECE_TYPES; type++) {
+			int missing = INITIAL_COUNT[type] - bb_popcount(board->pieces[color][type]);
+			board->captured[color][type] = (missing > 0 ? missing: 0);
+		}
+	}
+
+	// en passant square is behind a pawn of the side not to move that just double stepped, the square it stepped from is left empty
+	color_t color = (board->chance & BLACK ? 1: 0);
+	if (board->ep_square != NO_SQUARE) {
+		int ep = board->ep_square, step = (color ? -8: 8);
+		if (square_row(ep) != (color ? 2: 5) || !(board->pieces[!color][piece_index(PAWN)] & square_bb(ep - step))
+			|| (occupancy(board) & (square_bb(ep) | square_bb(ep + step))))
+			return false;
+	}
+
+	// en passant square is kept only if it can be used, same as chess_engine.c:make_move
+	if (board->ep_square != NO_SQUARE && !(PAWN_ATTACKS[!color][board->ep_square] & board->pieces[color][piece_index(PAWN)])) {
+		board->ep_square = NO_SQUARE;
+		board->key = compute_key(board);
+	}
+
+	return true;
 }
 
 
-void promote_pawn (piece_t *piece, const face_t piece_type) {
-	if (piece == NULL || !(piece->face & PAWN))
-		return;
-	piece->face ^= PAWN;
-	piece->face |= piece_type;
+void pack_board (const board_t *board, packed_board_t *packed) {
+	memset(packed->squares, 0, sizeof(packed->squares));
+	for (bitboard_t pieces = occupancy(board); pieces; ) {
+		int sq = pop_lsb(&pieces);
+		face_t face = board->tiles[square_row(sq)][square_col(sq)].piece.face;
+		packed->squares[sq >> 1] |= ((piece_index(face) + 1) | (is_black(face) << 3)) << (4 * (sq & 1));
+	}
+	packed->state = (board->chance & BLACK ? 1: 0) | (board->castling << 1);
+	packed->ep_square = board->ep_square;
+}
+
+
+/* sets position part of board (tiles, bitboards, attack map, key), leaves clocks, captured pieces and result to caller */
+void unpack_board (const packed_board_t *packed, board_t *board) {
+	board->chance = (packed->state & 1 ? BLACK: WHITE);
+	board->castling = packed->state >> 1;
+	board->ep_square = packed->ep_square;
+
+	for (int sq = 0; sq < 64; sq++) {
+		tile_t *tile = &board->tiles[square_row(sq)][square_col(sq)];
+		int nibble = (packed->squares[sq >> 1] >> (4 * (sq & 1))) & 15;
+		tile->row = square_row(sq);
+		tile->col = square_col(sq);
+		tile->can_be_dest = false;
+		tile->piece = EMPTY_PIECE;
+		if (nibble == 0)
+			continue;
+		tile->piece.face = (1 << ((nibble & 7) - 1)) | (nibble & 8 ? BLACK: WHITE);
+		// only pawns on initial row and pieces holding castling rights count as not moved
+		tile->piece.is_moved = !((tile->piece.face & PAWN) && tile->row == (nibble & 8 ? 6: 1));
+	}
+
+	for (int color = 0; color < 2; color++) {
+		short row = (color ? 7: 0);
+		int king_side = (color ? BLACK_KING_SIDE: WHITE_KING_SIDE), queen_side = (color ? BLACK_QUEEN_SIDE: WHITE_QUEEN_SIDE);
+		if (board->castling & (king_side | queen_side))
+			board->tiles[row][4].piece.is_moved = false;
+		if (board->castling & king_side)
+			board->tiles[row][7].piece.is_moved = false;
+		if (board->castling & queen_side)
+			board->tiles[row][0].piece.is_moved = false;
+	}
+
+	sync_bitboards(board);
 }
 
 
-static piece_t* init_piece(short i, short j) {
+static piece_t init_piece(short i, short j) {
+	piece_t piece = EMPTY_PIECE;
 	// no piece
 	if (i > 1 && i < 6)
-		return NULL;
-
-	piece_t *piece = (piece_t*) malloc(sizeof(piece_t));
-	memset(piece, 0, sizeof(piece_t));
+		return piece;
 
-	if (i >= 6) piece->face |= BLACK;
+	if (i >= 6) piece.face |= BLACK;
 	if (i == 1 || i == 6) {
-		piece->face |= PAWN;
+		piece.face |= PAWN;
 		return piece;
 	}
 
 	switch (j) {
 		case 0:
 		case 7:
-			piece->face |= ROOK;
+			piece.face |= ROOK;
 			break;
 		case 1:
 		case 6:
-			piece->face |= KNIGHT;
+			piece.face |= KNIGHT;
 			break;
 		case 2:
 		case 5:
-			piece->face |= BISHOP;
+			piece.face |= BISHOP;
 			break;
 		case 3:
-			piece->face |= QUEEN;
+			piece.face |= QUEEN;
 			break;
 		case 4:
-			piece->face |= KING;
+			piece.face |= KING;
 	}
 
 	return piece;
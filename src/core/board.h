@@ -2,9 +2,12 @@
 #define BOARD_H
 
 #include <wchar.h>
+#include <string.h>
 #include <stdint.h>
 #include <stdbool.h>
 
+#include "bitboard.h"
+
 #define ASCII			0
 
 #define WHITE			0
@@ -20,8 +23,23 @@
 #define PAWN			(1 << 5)
 #define piece_index(x)	((x&KING)? 0: (x&QUEEN)? 1: (x&ROOK)? 2: (x&BISHOP)? 3: (x&KNIGHT)? 4: (x&PAWN)? 5: -1)
 #define PIECE_TYPES		6
+#define color_index(x)	(is_black(x))
+#define occupancy(b)	((b)->occupied[0] | (b)->occupied[1])
+#define has_check(b, sq, color)	((b)->attacks[!(color)] & square_bb(sq) ? true: false)	// is sq attacked by enemy of color
+#define is_check(b, color)		((b)->attacks[!(color)] & (b)->pieces[color][piece_index(KING)] ? true: false)	// is king of color attacked
+
+// castling rights, bits of board_t castling mask
+#define WHITE_KING_SIDE		(1 << 0)
+#define WHITE_QUEEN_SIDE	(1 << 1)
+#define BLACK_KING_SIDE		(1 << 2)
+#define BLACK_QUEEN_SIDE	(1 << 3)
+#define ALL_CASTLING		(WHITE_KING_SIDE | WHITE_QUEEN_SIDE | BLACK_KING_SIDE | BLACK_QUEEN_SIDE)
+
+#define FIFTY_MOVE_PLIES	100	// game is drawn when halfmove clock reaches it
 
 #define NO_PIECE 0
+#define EMPTY_PIECE		((piece_t) { NO_PIECE, false })
+#define is_empty(tile)	((tile)->piece.face == NO_PIECE)
 #define INVALID_ROW -1
 #define INVALID_COL -1
 
@@ -34,7 +52,8 @@ typedef struct tile_t	tile_t;
 extern	const wchar_t	PIECES[2][2][6];
 extern	bool			SETTINGS_UNICODE_MODE;
 
-enum	result	{ STALE_MATE, WHITE_WON, BLACK_WON, PENDING };
+enum	result	{ STALE_MATE, WHITE_WON, BLACK_WON, PENDING, DRAW_BY_REPETITION, DRAW_BY_FIFTY_MOVES, DRAW_BY_MATERIAL };
+#define is_draw(result)	((result) == STALE_MATE || (result) >= DRAW_BY_REPETITION)
 
 typedef struct {
 	face_t face;
@@ -44,14 +63,21 @@ typedef struct {
 typedef struct tile_t {
 	short row;
 	short col;
-	piece_t *piece;
+	piece_t piece;	// face is NO_PIECE for empty tile
 	bool can_be_dest;
-	bool has_check[2];
 } tile_t;
 
+/* holds no pointers, so a board is copied with a plain memcpy */
 typedef struct board_t {
 	tile_t tiles[8][8];
-	tile_t *kings[2];
+	bitboard_t pieces[2][PIECE_TYPES];	// indexed by color and piece_index, mirrors tiles
+	bitboard_t occupied[2];
+	bitboard_t attacks[2];	// squares attacked by each color, non zero entries of attackers
+	uint8_t attackers[2][64];	// no. of pieces of each color attacking a square, maintained by attack_map.c
+	int ep_square;	// square passed by a pawn making double step in last move if an enemy pawn can capture on it, NO_SQUARE otherwise
+	uint8_t castling;	// castling rights still available, mask of WHITE_KING_SIDE.. bits
+	uint64_t key;	// zobrist key of the position, maintained by toggle_bitboards and make_move
+	short halfmove_clock;	// plies since last capture or pawn move, for fifty move rule
 	chance_t chance;
 	enum result result;
 	short captured[2][6];
@@ -59,6 +85,15 @@ typedef struct board_t {
 	int plr_times[2];	// in secs
 } board_t;
 
+/* canonical position in 34 bytes, equal positions pack to equal bytes */
+typedef struct {
+	uint8_t squares[32];	// a nibble per square, low nibble for even square, 0 for empty else piece_index + 1 with 8 for black
+	uint8_t state;			// bit 0 set for black to move, castling mask in bits 1-4
+	int8_t ep_square;
+} packed_board_t;
+
+#define packed_equal(a, b)	(memcmp((a), (b), sizeof(packed_board_t)) == 0)
+
 
 wchar_t		get_piece_face				(const piece_t *piece);
 void		init_board					(board_t *board, int time_limit);
@@ -66,6 +101,12 @@ void		copy_board					(board_t *dest_board, const board_t *src_board);
 void		delete_board				(board_t *board);
 char		get_piece_for_move_notation	(const piece_t *piece);
 void		promote_pawn				(piece_t *piece, const face_t piece_type);
+void		toggle_bitboards			(board_t *board, int sq, face_t face);
+void		sync_bitboards				(board_t *board);
+int			find_castling_rights		(const board_t *board);
+bool		load_fen					(board_t *board, const char *fen);
+void		pack_board					(const board_t *board, packed_board_t *packed);
+void		unpack_board				(const packed_board_t *packed, board_t *board);
 
 
 #endif
@@ -4,195 +4,303 @@
 #include "chess_engine.h"
 #include "game_menus.h"
 #include "board.h"
-
-#define INIT_ADD_MOVES \
-	tile_t **moves = (tile_t**) malloc(MAX_MOVES * sizeof(tile_t*));\
-	memset(moves, 0, MAX_MOVES * sizeof(tile_t*));\
- 	int idx = 0;\
-	face_t color = (tile->piece->face & BLACK);\
-	short row = tile->row;\
-	short col = tile->col;\
-	tile_t *dest = NULL;\
-	face_t dest_face;
-
-#define ADD_OR_BREAK \
-		dest = &board->tiles[i][j];\
-		dest_face = (dest->piece ? dest->piece->face : NO_PIECE);\
-		\
-		/* same color */\
-		if (dest_face != NO_PIECE && ((dest_face & BLACK) == color))\
-			break;\
-		\
-		moves[idx++] = dest;\
-		\
-		/* opp color */\
-		if (dest_face != NO_PIECE && !((dest_face & BLACK) == color))\
-			break;
-
-#define ADD_VLINE_MOVES	\
-	short j = col;\
-	/* -vline */\
-	for (short i = row-1; i >= 0; i--) {\
-		ADD_OR_BREAK\
-	}\
-	for (short i = row+1; i < 8; i++) {\
-		ADD_OR_BREAK\
-	}
-
-#define ADD_HLINE_MOVES \
-	short i = row;\
-	/* -hline */\
-	for (short j = col-1; j >= 0; j--) {\
-		ADD_OR_BREAK\
-	}\
-	/* +hline */\
-	for (short j = col+1; j < 8; j++) {\
-		ADD_OR_BREAK\
-	}
-
-#define ADD_PDIAG_MOVES \
-	/* -pdiag */\
-	for (short i = row-1, j = col-1; i >= 0 && j >= 0; i--, j--) {\
-		ADD_OR_BREAK\
-	}\
-	/* +pdiag */\
-	for (short i = i = row+1, j = col+1; i < 8 && j < 8; i++, j++) {\
-		ADD_OR_BREAK\
-	}
-
-#define ADD_SDIAG_MOVES \
-	/* -sdiag */\
-	for (short i = row-1, j = col+1; i >= 0 && j < 8; i--, j++) {\
-		ADD_OR_BREAK\
-	}\
-	/* +sdiag */\
-	for (short i = row+1, j = col-1; i < 8 && j >= 0; i++, j--) {\
-		ADD_OR_BREAK\
+#include "setwise.h"
+#include "attack_map.h"
+#include "zobrist.h"
+#include "draw.h"
+
+#define INIT_MASK_MOVES \
+	int sq = square_of(tile->row, tile->col);\
+	color_t color = color_index(tile->piece.face);\
+	bitboard_t own = board->occupied[color];\
+	bitboard_t mask = EMPTY_BB;
+
+#define CHECK_AT(tile) has_check(board, square_of(tile->row, tile->col), color)
+#define CHECK_AT_SQUARE(sq) has_check(board, sq, color)
+
+/* computed once per position and color, makes pseudo legal moves legal without trying them on a copy of board */
+typedef struct {
+	int			king;			// square of the king
+	bitboard_t	checkers;		// enemy pieces giving check
+	bitboard_t	pinned;			// own pieces pinned to the king
+	bitboard_t	check_mask;		// non king moves must end here, either capture the checker or block it
+	bitboard_t	king_danger;	// squares attacked by enemy with the king removed from board
+} legal_info_t;
+
+static	bitboard_t	king_moves			(const board_t *board, const tile_t *tile);
+static	bitboard_t	queen_moves			(const board_t *board, const tile_t *tile);
+static	bitboard_t	rook_moves			(const board_t *board, const tile_t *tile);
+static	bitboard_t	bishop_moves		(const board_t *board, const tile_t *tile);
+static	bitboard_t	knight_moves		(const board_t *board, const tile_t *tile);
+static	bitboard_t	pawn_moves			(const board_t *board, const tile_t *tile);
+static	bitboard_t	find_all_moves		(const board_t *board, const tile_t *tile);
+static	void		init_legal_info		(const board_t *board, color_t color, legal_info_t *info);
+static	bitboard_t	legal_moves_mask	(const board_t *board, const tile_t *tile, const legal_info_t *info);
+static	bool		is_legal_en_passant	(const board_t *board, int src, int dest, const legal_info_t *info);
+static	bitboard_t	king_danger_map		(const board_t *board, color_t color);
+static	void		add_moves			(const board_t *board, int from, bitboard_t mask, movelist_t *list);
+static	int			flags_of_move		(const board_t *board, int from, int to);
+static	bitboard_t	changed_squares		(move_t move);
+static	int			castling_kept		(int sq);
+static	bool		_move_piece			(board_t *board, short *dest_tile, short *src_tile, face_t promotion, history_t *history);
+static	void		find_move_notation	(const board_t *board, const movelist_t *list, move_t move, char *move_notation);
+
+
+int generate_moves (const board_t *board, movelist_t *list) {
+	color_t color = (board->chance & BLACK ? 1: 0);
+	legal_info_t info;
+	init_legal_info(board, color, &info);
+
+	list->count = 0;
+	bitboard_t pieces = board->occupied[color];
+	while (pieces) {
+		int sq = pop_lsb(&pieces);
+		const tile_t *tile = &board->tiles[square_row(sq)][square_col(sq)];
+		add_moves(board, sq, legal_moves_mask(board, tile, &info), list);
 	}
 
-#define CHECK_AT(tile) (tile->has_check[(color & BLACK) ? 1 : 0])
-
-static	tile_t**	king_moves			(board_t *board, const tile_t *tile);
-static	tile_t**	queen_moves			(board_t *board, const tile_t *tile);
-static	tile_t**	rook_moves			(board_t *board, const tile_t *tile);
-static	tile_t**	bishop_moves		(board_t *board, const tile_t *tile);
-static	tile_t**	knight_moves		(board_t *board, const tile_t *tile);
-static	tile_t**	pawn_moves			(board_t *board, const tile_t *tile, const history_t *history);
-static	tile_t**	find_all_moves		(board_t *board, const tile_t *tile, const history_t *history);
-static	void		update_check_map	(board_t *board);
-static	bool		is_valid_move		(board_t board, short *dest_tile, short *src_tile);
-static	void		find_move_notation	(const board_t *board, const short *const dest_tile, const short *const src_tile, char *move_notation);
-static	bool		is_reachable		(board_t *board, const tile_t *const dest_tile, const tile_t *const src_tile, const history_t *const history);
-
+	return list->count;
+}
 
-tile_t** find_moves(board_t *board, const tile_t *tile, const history_t *history) {
-	tile_t **all_moves = find_all_moves(board, tile, history);
-	if (all_moves == NULL)
-		return NULL;
 
-	short src_tile[2] = {tile->row, tile->col};
+bool play_move (board_t *board, move_t move, history_t *history) {
+	int from = move_from(move), to = move_to(move);
+	short src_tile[2] = { square_row(from), square_col(from) }, dest_tile[2] = { square_row(to), square_col(to) };
 
-	tile_t **moves = (tile_t**) malloc(MAX_MOVES * sizeof(tile_t*));
-	memset(moves, 0, MAX_MOVES * sizeof(tile_t*));
-	int k = 0;
-	for (int i = 0; i < MAX_MOVES && all_moves[i] != NULL; i++) {
-		short dest_tile[2] = {all_moves[i]->row, all_moves[i]->col};
-		if (is_valid_move(*board, dest_tile, src_tile))
-			moves[k++] = all_moves[i];
-	}
+	/* the move comes from generate_moves, so mark its destination to make it pass move_piece checks */
+	board->tiles[dest_tile[0]][dest_tile[1]].can_be_dest = true;
+	bool return_value = _move_piece(board, dest_tile, src_tile, is_promotion(move) ? promotion_face(move): 0, history);
+	board->tiles[dest_tile[0]][dest_tile[1]].can_be_dest = false;
 
-	free(all_moves);
+	return return_value;
+}
 
-	if (k == 0) {
-		free(moves);
-		moves = NULL;
-	}
 
-	return moves;
+bool move_piece (board_t *board, short *dest_tile, short *src_tile, history_t *history) {
+	return _move_piece(board, dest_tile, src_tile, 0, history);
 }
 
 
-bool move_piece (board_t *board, short *dest_tile, short *src_tile, history_t *history) {
+/* promotion is the face pawn promotes to, 0 to ask the player (or QUEEN on fake boards) */
+static bool _move_piece (board_t *board, short *dest_tile, short *src_tile, face_t promotion, history_t *history) {
 	short r1 = src_tile[0], c1 = src_tile[1], r2 = dest_tile[0], c2 = dest_tile[1];
 	// invalid tiles
-	if (r1 == INVALID_ROW || r2 == INVALID_ROW || c1 == INVALID_COL || c2 == INVALID_COL || board->tiles[r1][c1].piece == NULL)
+	if (r1 == INVALID_ROW || r2 == INVALID_ROW || c1 == INVALID_COL || c2 == INVALID_COL || is_empty(&board->tiles[r1][c1]))
 		return false;
 
 	
 	/* CAN NOT REMOVE can_be_dest checking, removing it breaks the game as player can move anywhare safe */
 	// impossible move
-	if (board->tiles[r1][c1].piece == NULL || !(board->tiles[r2][c2].can_be_dest))
+	if (is_empty(&board->tiles[r1][c1]) || !(board->tiles[r2][c2].can_be_dest))
 		return false;
 
-	// find move notation to store in history
-	char move_notation[MAX_MOVE_NOTATION_SIZE];
-	find_move_notation(board, dest_tile, src_tile, move_notation);
+	int from = square_of(r1, c1), to = square_of(r2, c2);
+	int flags = flags_of_move(board, from, to);
 
-	face_t piece_face = board->tiles[r1][c1].piece->face;
-	color_t enemy_color = !is_black(piece_face);
+	// if at end, promote the PAWN
+	if (flags & PROMOTION) {
+		/* game_menus.c:show_promote_menu shouldn't be called for AI. Can't condition on if turn is of HUMAN or AI as AI will simmulate HUMAN's turn also. Use new bool member 'is_fake' of board_t which is set to true when board is being simulated by AI. */
+		if (!promotion)
+			promotion = (board->is_fake ? QUEEN: show_promote_menu(board->chance & BLACK ? 1: 0));	// AI assumes best move
+		flags |= promotion_flag(promotion);
+	}
+	move_t move = encode_move(from, to, flags);
+
+	/* notation is only kept for moves committed to a real history, simulated moves never pay for it */
+	char move_notation[MAX_MOVE_NOTATION_SIZE] = "";
+	bool notate = (history != NULL && !board->is_fake);
+	if (notate) {
+		movelist_t list;
+		generate_moves(board, &list);
+		find_move_notation(board, &list, move, move_notation);
+	}
 
-	// en passant
-	if ((piece_face & PAWN) && (c1 != c2) && (board->tiles[r2][c2].piece == NULL)) {
-		board->tiles[r1][c2].piece = NULL;
-		board->captured[enemy_color][piece_index(PAWN)]++;
+	undo_t undo;
+	make_move(board, move, &undo);
+
+	// result is always updated for the game loop, notation gets check and checkmate marks
+	bool is_mate = (is_game_finished(board, history) && (board->result == BLACK_WON || board->result == WHITE_WON));
+	if (notate) {
+		int k = 0;
+		while (k < MAX_MOVE_NOTATION_SIZE && move_notation[k] != '\0') k++;
+		if (is_mate)
+			move_notation[k++] = '#';
+		else if (in_check(board))
+			move_notation[k++] = '+';
+		move_notation[k] = '\0';
 	}
 
-	// castling
-	if ((piece_face & KING) && (c1-c2 == 2 || c2-c1 == 2)) {
-		short rook_dest[2] = {r1, INVALID_COL}, rook_src[2] = {r1, INVALID_COL};
-		if (c2 == c1-2) {
-			rook_src[1] = 0;
-			rook_dest[1] = 3;
-		} else if (c2 == c1+2) {
-			rook_src[1] = 7;
-			rook_dest[1] = 5;
-		}
-		move_piece(board, rook_dest, rook_src, NULL);
-		/* the above function call to move_piece would change the turn also, thus turn it back */
-		board->chance = (board->chance == WHITE ? BLACK: WHITE);
+	if (history)
+		add_move(history, board, move_notation);
+
+	return true;
+}
+
+
+/* squares whose piece changes with the move, rooks included for castling */
+static bitboard_t changed_squares (move_t move) {
+	int from = move_from(move), to = move_to(move), flags = move_flags(move);
+	bitboard_t changed = square_bb(from) | square_bb(to);
+
+	if (flags == EN_PASSANT)
+		changed |= square_bb(square_of(square_row(from), square_col(to)));
+	else if (flags == KING_CASTLE)
+		changed |= square_bb(from + 3) | square_bb(from + 1);
+	else if (flags == QUEEN_CASTLE)
+		changed |= square_bb(from - 4) | square_bb(from - 1);
+
+	return changed;
+}
+
+
+/* castling rights that survive a move from or to sq, moving king or rook (or capturing rook) loses them */
+static int castling_kept (int sq) {
+	switch (sq) {
+		case 0:
+			return ~WHITE_QUEEN_SIDE;
+		case 4:
+			return ~(WHITE_KING_SIDE | WHITE_QUEEN_SIDE);
+		case 7:
+			return ~WHITE_KING_SIDE;
+		case 56:
+			return ~BLACK_QUEEN_SIDE;
+		case 60:
+			return ~(BLACK_KING_SIDE | BLACK_QUEEN_SIDE);
+		case 63:
+			return ~BLACK_KING_SIDE;
 	}
+	return ALL_CASTLING;
+}
 
-	face_t enemy_piece_face = board->tiles[r2][c2].piece ? board->tiles[r2][c2].piece->face : 0;
-	if (enemy_piece_face != 0)
-		board->captured[enemy_color][piece_index(enemy_piece_face)]++;
 
-	board->tiles[r2][c2].piece = board->tiles[r1][c1].piece;
-	board->tiles[r1][c1].piece = NULL;
-	board->tiles[r2][c2].piece->is_moved = true;
+void make_move (board_t *board, move_t move, undo_t *undo) {
+	int from = move_from(move), to = move_to(move), flags = move_flags(move);
+	tile_t *src = &board->tiles[square_row(from)][square_col(from)];
+	tile_t *dest = &board->tiles[square_row(to)][square_col(to)];
+	piece_t piece = src->piece;
+	color_t color = color_index(piece.face);
+
+	undo->captured = EMPTY_PIECE;
+	undo->is_moved = piece.is_moved;
+	undo->rook_is_moved = false;
+	undo->ep_square = board->ep_square;
+	undo->castling = board->castling;
+	undo->key = board->key;
+	undo->halfmove_clock = board->halfmove_clock;
+
+	// pieces are hashed by toggle_bitboards, rest of the key is updated here
+	board->key ^= ep_key(board->ep_square) ^ castling_key(board->castling);
+	board->castling &= castling_kept(from) & castling_kept(to);
+
+	// remove attacks affected by this move from the attack map, added back after pieces are placed
+	bitboard_t touched = detach_attacks(board, changed_squares(move));
+
+	if (flags & CAPTURE) {
+		tile_t *captured = (flags == EN_PASSANT ? &board->tiles[square_row(from)][square_col(to)]: dest);
+		undo->captured = captured->piece;
+		toggle_bitboards(board, square_of(captured->row, captured->col), captured->piece.face);
+		board->captured[!color][piece_index(captured->piece.face)]++;
+		captured->piece = EMPTY_PIECE;
+	}
 
-	// if at end, promote the PAWN and add to the move_notation
-	piece_t *piece = board->tiles[r2][c2].piece;
-	if ((piece->face & PAWN) && ((is_black(piece->face) && r2 == 0) || (!is_black(piece->face) && r2 == 7))) {
-		int k = 0;
-		while (k < MAX_MOVE_NOTATION_SIZE && move_notation[k] != '\0') k++;
-		/* game_menus.c:show_promote_menu shouldn't be called for AI. Can't condition on if turn is of HUMAN or AI as AI will simmulate HUMAN's turn also. Use new bool member 'is_fake' of board_t which is set to true when board is being simulated by AI. */
-		if (board->is_fake)
-			promote_pawn(piece, QUEEN);	// AI assumes best move
-		else
-			promote_pawn(piece, show_promote_menu(is_black(piece->face)));
-		move_notation[k++] = PIECES[ASCII][is_black(piece->face)][piece_index(piece->face)];
+	// castling, move the rook here so that the attack map is updated once for the whole move
+	if (flags == KING_CASTLE || flags == QUEEN_CASTLE) {
+		int rook_from = (flags == KING_CASTLE ? from + 3: from - 4), rook_to = (flags == KING_CASTLE ? from + 1: from - 1);
+		tile_t *rook_src = &board->tiles[square_row(rook_from)][square_col(rook_from)];
+		tile_t *rook_dest = &board->tiles[square_row(rook_to)][square_col(rook_to)];
+		undo->rook_is_moved = rook_src->piece.is_moved;
+		toggle_bitboards(board, rook_from, rook_src->piece.face);
+		toggle_bitboards(board, rook_to, rook_src->piece.face);
+		rook_dest->piece.face = rook_src->piece.face;
+		rook_dest->piece.is_moved = true;
+		rook_src->piece = EMPTY_PIECE;
 	}
 
-	// update king position in board
-	if (piece_face & KING)
-		board->kings[piece_face & BLACK ? 1: 0] = &(board->tiles[r2][c2]);
+	toggle_bitboards(board, from, piece.face);
+	piece.is_moved = true;
+	if (flags & PROMOTION)
+		promote_pawn(&piece, promotion_face(move));
+	dest->piece = piece;
+	src->piece = EMPTY_PIECE;
+	toggle_bitboards(board, to, piece.face);
+
+	attach_attacks(board, touched);
+
+	// en passant square is only kept if it can be used, so that it doesn't split equal positions in key
+	int passed = (from + to) / 2;
+	board->ep_square = (flags == DOUBLE_PUSH && (PAWN_ATTACKS[color][passed] & board->pieces[!color][piece_index(PAWN)]) ? passed: NO_SQUARE);
+	// piece is already promoted here, promotion flag stands for the pawn move
+	board->halfmove_clock = ((flags & (CAPTURE | PROMOTION)) || (piece.face & PAWN) ? 0: board->halfmove_clock + 1);
+	board->chance = (board->chance == WHITE ? BLACK: WHITE);
+	board->key ^= ep_key(board->ep_square) ^ castling_key(board->castling) ^ ZOBRIST_CHANCE;
+}
+
+
+void unmake_move (board_t *board, move_t move, const undo_t *undo) {
+	int from = move_from(move), to = move_to(move), flags = move_flags(move);
+	tile_t *src = &board->tiles[square_row(from)][square_col(from)];
+	tile_t *dest = &board->tiles[square_row(to)][square_col(to)];
+	piece_t piece = dest->piece;
 
 	board->chance = (board->chance == WHITE ? BLACK: WHITE);
+	board->ep_square = undo->ep_square;
+	board->castling = undo->castling;
+	board->halfmove_clock = undo->halfmove_clock;
+
+	bitboard_t touched = detach_attacks(board, changed_squares(move));
+
+	toggle_bitboards(board, to, piece.face);
+	if (flags & PROMOTION)
+		piece.face = PAWN | (piece.face & BLACK);
+	toggle_bitboards(board, from, piece.face);
+	piece.is_moved = undo->is_moved;
+	src->piece = piece;
+	dest->piece = EMPTY_PIECE;
+
+	if (flags == KING_CASTLE || flags == QUEEN_CASTLE) {
+		int rook_from = (flags == KING_CASTLE ? from + 3: from - 4), rook_to = (flags == KING_CASTLE ? from + 1: from - 1);
+		tile_t *rook_src = &board->tiles[square_row(rook_from)][square_col(rook_from)];
+		tile_t *rook_dest = &board->tiles[square_row(rook_to)][square_col(rook_to)];
+		toggle_bitboards(board, rook_to, rook_dest->piece.face);
+		toggle_bitboards(board, rook_from, rook_dest->piece.face);
+		rook_src->piece.face = rook_dest->piece.face;
+		rook_src->piece.is_moved = undo->rook_is_moved;
+		rook_dest->piece = EMPTY_PIECE;
+	}
 
-	// check for check and checkmate
-	int k = 0;
-	while (k < MAX_MOVE_NOTATION_SIZE && move_notation[k] != '\0') k++;
-	color_t color = (board->chance & BLACK ? 1: 0);
-	if (is_game_finished(board, history) && (board->result == BLACK_WON || board->result == WHITE_WON))
-		move_notation[k++] = '#';
-	else if (board->kings[color]->has_check[color])
-		move_notation[k++] = '+';
-	move_notation[k] = '\0';
+	if (flags & CAPTURE) {
+		tile_t *captured = (flags == EN_PASSANT ? &board->tiles[square_row(from)][square_col(to)]: dest);
+		captured->piece = undo->captured;
+		toggle_bitboards(board, square_of(captured->row, captured->col), undo->captured.face);
+		board->captured[!color_index(piece.face)][piece_index(undo->captured.face)]--;
+	}
 
-	if (history)
-		add_move(history, board, move_notation);
+	attach_attacks(board, touched);
 
-	return true;
+	// toggle_bitboards changed the key on the way, restore it as a whole
+	board->key = undo->key;
+}
+
+
+/* passes the turn, only search uses it (null move pruning). pieces stay so attack map stays valid */
+void make_null_move (board_t *board, undo_t *undo) {
+	undo->ep_square = board->ep_square;
+	undo->key = board->key;
+	undo->halfmove_clock = board->halfmove_clock;
+
+	board->key ^= ep_key(board->ep_square) ^ ZOBRIST_CHANCE;
+	board->ep_square = NO_SQUARE;
+	// positions before it don't repeat after it, clock keeps repetitions from being looked for across it
+	board->halfmove_clock = 0;
+	board->chance = (board->chance == WHITE ? BLACK: WHITE);
+}
+
+
+void unmake_null_move (board_t *board, const undo_t *undo) {
+	board->chance = (board->chance == WHITE ? BLACK: WHITE);
+	board->ep_square = undo->ep_square;
+	board->halfmove_clock = undo->halfmove_clock;
+	board->key = undo->key;
 }
 
 
@@ -205,11 +313,13 @@ void clear_dest (board_t *board) {
 }
 
 
-void set_dest (board_t *board, tile_t **moves) {
-	if (moves == NULL)
-		return;
-	for (int i = 0; i < MAX_MOVES && moves[i] != NULL; i++) {
-		moves[i]->can_be_dest = true;
+// mark destinations of moves in list starting at from square
+void set_dest (board_t *board, const movelist_t *list, int from) {
+	for (int i = 0; i < list->count; i++) {
+		if (move_from(list->moves[i]) != from)
+			continue;
+		int to = move_to(list->moves[i]);
+		board->tiles[square_row(to)][square_col(to)].can_be_dest = true;
 	}
 }
 
@@ -217,31 +327,17 @@ void set_dest (board_t *board, tile_t **moves) {
 bool is_game_finished (board_t *board, const history_t *history) {
 	if (board->result != PENDING) return true;
 
-	color_t color = (board->chance & BLACK ? 1: 0);
-	update_check_map(board);
-	bool is_check = board->kings[color]->has_check[color];
-
-	for (short i = 0; i < 8; i++) {
-		for (short j = 0; j < 8; j++) {
-			if (board->tiles[i][j].piece == NULL)
-				continue;
-
-			color_t piece_color = board->tiles[i][j].piece->face & BLACK ? 1: 0;
-			if (piece_color != color)
-				continue;
-
-			tile_t **moves = find_moves(board, &board->tiles[i][j], history);
-			bool move_exists = (moves != NULL);
-			free(moves);
-
-			if (move_exists) {
-				board->result = PENDING;
-				return false;
-			}
-		}
+	// history holds the positions before board, threefold repetition needs two of them equal to board
+	if (has_legal_move(board)) {
+		key_stack_t stack;
+		stack.count = 0;
+		if (history)
+			init_key_stack(&stack, history);
+		board->result = find_draw(board, &stack, 2);
+		return (board->result != PENDING);
 	}
 
-	if (is_check)
+	if (in_check(board))
 		board->result = (board->chance == WHITE ? BLACK_WON: WHITE_WON);
 	else
 		board->result = STALE_MATE;
@@ -250,304 +346,329 @@ bool is_game_finished (board_t *board, const history_t *history) {
 }
 
 
-static tile_t** king_moves (board_t *board, const tile_t *tile) {
-	INIT_ADD_MOVES;
-
-	for (short i = -1; i < 2; i++) {
-		for (short j = -1; j < 2; j++) {
-			// same tile
-			if (i == 0 && j == 0)
-				continue;
-			// out of board
-			if (row+i < 0 || row+i > 7 || col+i < 0 || col+i > 7)
-				continue;
-			dest = &board->tiles[row+i][col+j];
-			dest_face = (dest->piece ? dest->piece->face : NO_PIECE);
-			// same color piece
-			if (dest_face != NO_PIECE && ((dest_face & BLACK) == color))
-				continue;
-			// check at dest
-			if (CHECK_AT(dest))
-				continue;
-
-			moves[idx++] = dest;
-		}
+// is king of the side to move attacked
+bool in_check (const board_t *board) {
+	return is_check(board, board->chance & BLACK ? 1: 0);
+}
+
+
+/* stops at the first legal move found, nothing is generated or copied */
+bool has_legal_move (const board_t *board) {
+	color_t color = (board->chance & BLACK ? 1: 0);
+	legal_info_t info;
+	init_legal_info(board, color, &info);
+
+	// king first, castling needs the square next to king safe so a single step covers it
+	if (KING_ATTACKS[info.king] & ~board->occupied[color] & ~info.king_danger)
+		return true;
+	// double check, only king could have moved
+	if (info.check_mask == EMPTY_BB)
+		return false;
+
+	// unpinned knights need no move generation
+	bitboard_t knights = board->pieces[color][piece_index(KNIGHT)] & ~info.pinned;
+	while (knights) {
+		if (KNIGHT_ATTACKS[pop_lsb(&knights)] & ~board->occupied[color] & info.check_mask)
+			return true;
 	}
 
-	// castling
-	if (CHECK_AT(tile) || tile->piece->is_moved)
-		return moves;
-
-	if (board->tiles[row][0].piece != NULL && !(board->tiles[row][0].piece->is_moved)) {
-		bool flag = true;
-		dest = &board->tiles[row][1];
-		if (dest->piece != NULL)
-			flag = false;
-		dest = &board->tiles[row][2];
-		if ((flag && dest->piece != NULL) || CHECK_AT(dest))
-			flag = false;
-		dest = &board->tiles[row][3];
-		if ((flag && dest->piece != NULL) || CHECK_AT(dest))
-			flag = false;
-		if (flag)
-			moves[idx++] = &board->tiles[row][col-2];
-	} 
-
-	if (board->tiles[row][7].piece != NULL && !(board->tiles[row][7].piece->is_moved)) {
-		bool flag = true;
-		dest = &board->tiles[row][5];
-		if (dest->piece != NULL || CHECK_AT(dest))
-			flag = false;
-		dest = &board->tiles[row][6];
-		if ((flag && dest->piece != NULL) || CHECK_AT(dest))
-			flag = false;
-		if (flag)
-			moves[idx++] = &board->tiles[row][col+2];
+	bitboard_t pieces = board->occupied[color] & ~board->pieces[color][piece_index(KING)] & ~board->pieces[color][piece_index(KNIGHT)];
+	while (pieces) {
+		int sq = pop_lsb(&pieces);
+		if (legal_moves_mask(board, &board->tiles[square_row(sq)][square_col(sq)], &info) != EMPTY_BB)
+			return true;
 	}
 
-	return moves;
+	return false;
 }
 
 
-static tile_t** queen_moves (board_t *board, const tile_t *tile) {
-	INIT_ADD_MOVES;
+static bitboard_t king_moves (const board_t *board, const tile_t *tile) {
+	INIT_MASK_MOVES;
+
+	bitboard_t targets = KING_ATTACKS[sq] & ~own;
+	while (targets) {
+		int dest = pop_lsb(&targets);
+		// check at dest
+		if (!CHECK_AT_SQUARE(dest))
+			mask |= square_bb(dest);
+	}
+
+	// castling, rights imply that king and rook are on their initial tiles
+	int king_side = (color ? BLACK_KING_SIDE: WHITE_KING_SIDE), queen_side = (color ? BLACK_QUEEN_SIDE: WHITE_QUEEN_SIDE);
+	if (!(board->castling & (king_side | queen_side)) || CHECK_AT(tile))
+		return mask;
 
-	ADD_VLINE_MOVES;
-	ADD_HLINE_MOVES;
-	ADD_PDIAG_MOVES;
-	ADD_SDIAG_MOVES;
+	bitboard_t occupied = occupancy(board);
+	if ((board->castling & queen_side) && !(occupied & (square_bb(sq-1) | square_bb(sq-2) | square_bb(sq-3))) && !CHECK_AT_SQUARE(sq-1) && !CHECK_AT_SQUARE(sq-2))
+		mask |= square_bb(sq-2);
+	if ((board->castling & king_side) && !(occupied & (square_bb(sq+1) | square_bb(sq+2))) && !CHECK_AT_SQUARE(sq+1) && !CHECK_AT_SQUARE(sq+2))
+		mask |= square_bb(sq+2);
 
-	return moves;
+	return mask;
 }
 
 
-static tile_t** rook_moves (board_t *board, const tile_t *tile) {
-	INIT_ADD_MOVES;
+static bitboard_t queen_moves (const board_t *board, const tile_t *tile) {
+	INIT_MASK_MOVES;
 
-	ADD_VLINE_MOVES;
-	ADD_HLINE_MOVES;
+	mask = queen_attacks(sq, occupancy(board)) & ~own;
 
-	return moves;
+	return mask;
 }
 
 
-static tile_t** bishop_moves (board_t *board, const tile_t *tile) {
-	INIT_ADD_MOVES;
+static bitboard_t rook_moves (const board_t *board, const tile_t *tile) {
+	INIT_MASK_MOVES;
 
-	ADD_PDIAG_MOVES;
-	ADD_SDIAG_MOVES;
+	mask = rook_attacks(sq, occupancy(board)) & ~own;
 
-	return moves;
+	return mask;
 }
 
 
-static tile_t** knight_moves (board_t *board, const tile_t *tile) {
-	INIT_ADD_MOVES;
+static bitboard_t bishop_moves (const board_t *board, const tile_t *tile) {
+	INIT_MASK_MOVES;
 
-	for (short i = -2; i <= 2; i++) {
-		for (short j = -2; j <= 2; j++) {
-			// lines or diags
-			if (i == 0 || j == 0 || i == j || i == -j)
-				continue;
+	mask = bishop_attacks(sq, occupancy(board)) & ~own;
 
-			// out of board
-			if (row+i < 0 || row+i > 7 || col+j < 0 || col+j > 7)
-				continue;
+	return mask;
+}
 
-			dest = &board->tiles[row+i][col+j];
-			dest_face = (dest->piece ? dest->piece->face : NO_PIECE);
 
-			// same color
-			if (dest_face != NO_PIECE && ((dest_face & BLACK) == color))
-				continue;
+static bitboard_t knight_moves (const board_t *board, const tile_t *tile) {
+	INIT_MASK_MOVES;
 
-			moves[idx++] = dest;
-		}
-	}
+	mask = KNIGHT_ATTACKS[sq] & ~own;
 
-	return moves;
+	return mask;
 }
 
 
-static tile_t** pawn_moves (board_t *board, const tile_t *tile, const history_t *history) {
-	INIT_ADD_MOVES;
+static bitboard_t pawn_moves (const board_t *board, const tile_t *tile) {
+	INIT_MASK_MOVES;
 
-	int origin_row = (color == BLACK ? 6: 1);
-	int enemy_origin_row = (color == BLACK ? 1: 6);
-	int forward = (color == BLACK ? -1: 1);
+	short row = tile->row;
+	short col = tile->col;
+	int origin_row = (color ? 6: 1);
+	int forward = (color ? -1: 1);
 
-	// double step
-	if (row == origin_row && board->tiles[row + forward][col].piece == NULL && board->tiles[row + 2*forward][col].piece == NULL)
-		moves[idx++] = &board->tiles[row + 2*forward][col];
+	/* PAWN is always promoted on reaching last row, but guard against indexing out of board */
+	if (row + forward < 0 || row + forward > 7)
+		return mask;
 
-	// single step
-	dest = &board->tiles[row + forward][col];
-	if (dest->piece == NULL)
-		moves[idx++] = dest;
+	// single step and double step
+	bitboard_t occupied = occupancy(board);
+	bitboard_t enemy = occupied & ~own;
+	int step = square_of(row + forward, col);
+	if (!(occupied & square_bb(step))) {
+		mask |= square_bb(step);
+		if (row == origin_row && !(occupied & square_bb(step + 8*forward)))
+			mask |= square_bb(step + 8*forward);
+	}
 
 	// attack moves
-	for (short i = -1; i < 2; i++) {
-		if (i == 0 || col + i < 0 || col + i > 7)
-			continue;
-		dest = &board->tiles[row + forward][col+i];
-		dest_face = (dest->piece ? dest->piece->face : NO_PIECE);
-		if (dest_face != NO_PIECE && !((dest_face & BLACK) == color)) {
-			moves[idx++] = dest;
-			continue;
-		}
+	mask |= PAWN_ATTACKS[color][sq] & enemy;
 
-		// en passant
-		if (history == NULL || get_size(history) < 2 || row != (origin_row + 3*forward))
-			continue;
-		tile_t side_tile = board->tiles[row][col+i];
-		tile_t side_tile_origin = board->tiles[enemy_origin_row][col+i];
-		face_t side_face = (side_tile.piece ? side_tile.piece->face : NO_PIECE);
-		face_t side_origin_face = (side_tile_origin.piece ? side_tile_origin.piece->face : NO_PIECE);
-		if ((side_face & PAWN) && !(side_origin_face & PAWN) && (side_face & BLACK) != color) {
-			const board_t *bef_prev_move_board = peek_board(history, 1);
-			tile_t enemy_pawn_origin = bef_prev_move_board->tiles[enemy_origin_row][col+i];
-			face_t enemy_pawn_origin_face = (enemy_pawn_origin.piece ? enemy_pawn_origin.piece->face : NO_PIECE);
-			if ((enemy_pawn_origin_face & PAWN) && (enemy_pawn_origin_face & BLACK) != color)
-				moves[idx++] = dest;
-		}
-	}
+	// en passant
+	if (board->ep_square != NO_SQUARE)
+		mask |= PAWN_ATTACKS[color][sq] & square_bb(board->ep_square);
 
-	return moves;
+	return mask;
 }
 
 
-static tile_t** find_all_moves (board_t *board, const tile_t *tile, const history_t *history) {
+static bitboard_t find_all_moves (const board_t *board, const tile_t *tile) {
 	// no piece at tile to move
-	if (tile->piece == NULL)
-		return NULL;
-
-	tile_t **all_moves = NULL;
+	if (is_empty(tile))
+		return EMPTY_BB;
 
 	int type = 1;
-	while (!(tile->piece->face & type)) type <<= 1;
+	while (!(tile->piece.face & type)) type <<= 1;
 
 	switch (type) {
 		case KING:
-			all_moves = king_moves(board, tile);
-			break;
+			return king_moves(board, tile);
 		case QUEEN:
-			all_moves = queen_moves(board, tile);
-			break;
+			return queen_moves(board, tile);
 		case ROOK:
-			all_moves = rook_moves(board, tile);
-			break;
+			return rook_moves(board, tile);
 		case BISHOP:
-			all_moves = bishop_moves(board, tile);
-			break;
+			return bishop_moves(board, tile);
 		case KNIGHT:
-			all_moves = knight_moves(board, tile);
-			break;
+			return knight_moves(board, tile);
 		case PAWN:
-			all_moves = pawn_moves(board, tile, history);
+			return pawn_moves(board, tile);
 	}
 
-	return all_moves;
+	return EMPTY_BB;
 }
 
 
-static void update_check_map (board_t *board) {
-	// make each tile safe
-	for (short i = 0; i < 8; i++) {
-		for (short j = 0; j < 8; j++) {
-			board->tiles[i][j].has_check[0] = false;
-			board->tiles[i][j].has_check[1] = false;
-		}
+static void init_legal_info (const board_t *board, color_t color, legal_info_t *info) {
+	const bitboard_t *enemy = board->pieces[!color];
+	bitboard_t occupied = occupancy(board);
+	bitboard_t enemy_orthogonal = enemy[piece_index(ROOK)] | enemy[piece_index(QUEEN)];
+	bitboard_t enemy_diagonal = enemy[piece_index(BISHOP)] | enemy[piece_index(QUEEN)];
+	int king = bb_lsb(board->pieces[color][piece_index(KING)]);
+
+	info->king = king;
+	info->checkers = (PAWN_ATTACKS[color][king] & enemy[piece_index(PAWN)])
+					| (KNIGHT_ATTACKS[king] & enemy[piece_index(KNIGHT)])
+					| (rook_attacks(king, occupied) & enemy_orthogonal)
+					| (bishop_attacks(king, occupied) & enemy_diagonal);
+
+	// enemy sliders seeing the king through exactly one own piece pin it
+	info->pinned = EMPTY_BB;
+	bitboard_t snipers = (rook_attacks(king, board->occupied[!color]) & enemy_orthogonal) | (bishop_attacks(king, board->occupied[!color]) & enemy_diagonal);
+	while (snipers) {
+		bitboard_t blockers = BETWEEN[king][pop_lsb(&snipers)] & occupied;
+		if (bb_popcount(blockers) == 1)
+			info->pinned |= blockers & board->occupied[color];
 	}
 
-	for (short i = 0; i < 8; i++) {
-		for (short j = 0; j < 8; j++) {
-			tile_t *tile = &(board->tiles[i][j]);
-			if (tile->piece == NULL)
-				continue;
-
-			color_t color = (tile->piece->face & BLACK ? 1: 0);
-
-			tile_t **moves = NULL;
-			int type = 1;
-			while (!(tile->piece->face & type)) type <<= 1;
-			// special case for PAWN as it's all possible moves arn't attacking moves
-			if (type == PAWN) {
-				moves = (tile_t**) malloc(2 * sizeof(tile_t*));
-				memset(moves, 0, 2 * sizeof(tile_t*));
-
-				int row = i + 1;
-				if (color == 1)
-					row = i - 1;
-
-				/* checking for PAWN at last rows, (although they won't be PAWN and promoted to another piece type) but for working of AI which sees in future include this check. Promote to another piece in AI's perspective to predict better moves */
-				if (row < 0 || row > 7)
-					continue;
-				
-				if (j == 0)
-					moves[0] = &(board->tiles[row][j+1]);
-				else if (j == 7)
-					moves[0] = &(board->tiles[row][j-1]);
-				else {
-					moves[0] = &(board->tiles[row][j-1]);
-					moves[1] = &(board->tiles[row][j+1]);
-				}
-			} else {
-				moves = find_all_moves(board, tile, NULL);
-			}
-
-
-			for (int k = 0; k < (type == PAWN ? 2: MAX_MOVES) && moves[k] != NULL; k++) {
-				moves[k]->has_check[!color] = true;
-			}
+	if (info->checkers == EMPTY_BB)
+		info->check_mask = ~EMPTY_BB;
+	else if (bb_popcount(info->checkers) == 1)
+		info->check_mask = info->checkers | BETWEEN[king][bb_lsb(info->checkers)];
+	else
+		info->check_mask = EMPTY_BB;	// double check, only king can move
+
+	/* without check no enemy ray reaches the king, so the incremental attack map already is the danger map */
+	info->king_danger = (info->checkers == EMPTY_BB ? board->attacks[!color]: king_danger_map(board, color));
+}
+
+
+static bitboard_t legal_moves_mask (const board_t *board, const tile_t *tile, const legal_info_t *info) {
+	if (is_empty(tile))
+		return EMPTY_BB;
+
+	int sq = square_of(tile->row, tile->col);
+	face_t face = tile->piece.face;
+	bitboard_t mask = find_all_moves(board, tile);
+
+	if (face & KING)
+		return mask & ~info->king_danger;
+
+	bitboard_t allowed = info->check_mask;
+	if (info->pinned & square_bb(sq))
+		allowed &= LINE[info->king][sq];
+
+	// en passant captures two pieces off the board, verify it separately
+	bitboard_t en_passant = EMPTY_BB;
+	if (face & PAWN) {
+		bitboard_t targets = mask & PAWN_ATTACKS[color_index(face)][sq] & ~occupancy(board);
+		mask &= ~targets;
+		while (targets) {
+			int dest = pop_lsb(&targets);
+			if (is_legal_en_passant(board, sq, dest, info))
+				en_passant |= square_bb(dest);
 		}
 	}
+
+	return (mask & allowed) | en_passant;
 }
 
 
-/* this function assumes that it is called for destinations reachable from source, it validates the move by looking for possible threats to king and not by checking for reachability. Use is_reachable to check reachability. */
-static bool is_valid_move (board_t board, short *dest_tile, short *src_tile) {
-	color_t color = board.tiles[src_tile[0]][src_tile[1]].piece->face & BLACK ? 1: 0;
-	for (int i=0; i<2; i++)
-		board.kings[i] = &board.tiles[board.kings[i]->row][board.kings[i]->col];
-	tile_t *src= &board.tiles[src_tile[0]][src_tile[1]];
-	tile_t *dest = &board.tiles[dest_tile[0]][dest_tile[1]];
+static bool is_legal_en_passant (const board_t *board, int src, int dest, const legal_info_t *info) {
+	color_t color = (board->occupied[1] & square_bb(src) ? 1: 0);
+	const bitboard_t *enemy = board->pieces[!color];
+	int captured = square_of(square_row(src), square_col(dest));
+	bitboard_t occupied = (occupancy(board) ^ square_bb(src) ^ square_bb(captured)) | square_bb(dest);
+	int king = info->king;
 
-	if (src->piece->face & KING)
-		board.kings[color] = dest;
+	bitboard_t attackers = (rook_attacks(king, occupied) & (enemy[piece_index(ROOK)] | enemy[piece_index(QUEEN)]))
+						| (bishop_attacks(king, occupied) & (enemy[piece_index(BISHOP)] | enemy[piece_index(QUEEN)]))
+						| (KNIGHT_ATTACKS[king] & enemy[piece_index(KNIGHT)])
+						| (PAWN_ATTACKS[color][king] & enemy[piece_index(PAWN)] & ~square_bb(captured));
+	return attackers == EMPTY_BB;
+}
 
-	dest->piece = src->piece;
-	src->piece = NULL;
 
-	update_check_map(&board);
+/* squares attacked by enemy of color, computed in one pass of set-wise operations with the king of color removed so that squares behind the king on a checking ray count as attacked */
+static bitboard_t king_danger_map (const board_t *board, color_t color) {
+	const bitboard_t *white = board->pieces[0], *black = board->pieces[1];
+	bitboard_t orthogonal[2] = { white[piece_index(ROOK)] | white[piece_index(QUEEN)], black[piece_index(ROOK)] | black[piece_index(QUEEN)] };
+	bitboard_t diagonal[2] = { white[piece_index(BISHOP)] | white[piece_index(QUEEN)], black[piece_index(BISHOP)] | black[piece_index(QUEEN)] };
+	bitboard_t attacks[2];
 
-	return !(board.kings[color]->has_check[color]);
+	slider_attacks_setwise(orthogonal, diagonal, ~occupancy(board) | board->pieces[color][piece_index(KING)], attacks);
+	const bitboard_t *enemy = board->pieces[!color];
+	return attacks[!color]
+			| pawn_attacks_setwise(enemy[piece_index(PAWN)], !color)
+			| knight_attacks_setwise(enemy[piece_index(KNIGHT)])
+			| king_attacks_setwise(enemy[piece_index(KING)]);
 }
 
 
-static void find_move_notation (const board_t *board, const short *const dest_tile, const short *const src_tile, char* move_notation) {
-	short r1 = src_tile[0], c1 = src_tile[1], r2 = dest_tile[0], c2 = dest_tile[1];
+static void add_moves (const board_t *board, int from, bitboard_t mask, movelist_t *list) {
+	while (mask) {
+		int to = pop_lsb(&mask);
+		int flags = flags_of_move(board, from, to);
+
+		if (flags & PROMOTION) {
+			// one move per promoted piece
+			for (int promotion = 0; promotion < 4; promotion++)
+				list->moves[list->count++] = encode_move(from, to, flags | promotion);
+			continue;
+		}
+
+		list->moves[list->count++] = encode_move(from, to, flags);
+	}
+}
+
+
+/* flags of a legal move from -> to, promotions come without the promoted piece */
+static int flags_of_move (const board_t *board, int from, int to) {
+	face_t face = board->tiles[square_row(from)][square_col(from)].piece.face;
+	int flags = (board->occupied[!color_index(face)] & square_bb(to) ? CAPTURE: QUIET_MOVE);
+
+	if (face & PAWN) {
+		if (to == board->ep_square && square_col(from) != square_col(to))
+			return EN_PASSANT;
+		if (to - from == 16 || from - to == 16)
+			return DOUBLE_PUSH;
+		if (square_row(to) == 0 || square_row(to) == 7)
+			return flags | PROMOTION;
+	} else if ((face & KING) && (to - from == 2 || from - to == 2)) {
+		return (to > from ? KING_CASTLE: QUEEN_CASTLE);
+	}
+
+	return flags;
+}
+
+
+/* list holds the legal moves of board, the other moves to same square make the notation ambiguous */
+static void find_move_notation (const board_t *board, const movelist_t *list, move_t move, char *move_notation) {
+	int from = move_from(move), to = move_to(move), flags = move_flags(move);
+	short r1 = square_row(from), c1 = square_col(from), r2 = square_row(to), c2 = square_col(to);
 	int k = 0;
-	face_t piece_face = board->tiles[r1][c1].piece->face;
+	const piece_t *piece = &board->tiles[r1][c1].piece;
 
-	if (piece_face & PAWN) {
+	if (piece->face & PAWN) {
 		// attacking move
-		if (c1 != c2) {
+		if (flags & CAPTURE) {
 			move_notation[k++] = 'a' + c1;
 			move_notation[k++] = 'x';
 		}
 		move_notation[k++] = 'a' + c2;
 		move_notation[k++] = '1' + r2;
+		// promoted piece is uppercase for both sides, as in SAN
+		if (flags & PROMOTION) {
+			move_notation[k++] = '=';
+			move_notation[k++] = PIECES[ASCII][0][piece_index(promotion_face(move))];
+		}
 		move_notation[k++] = '\0';
 
 		return;
 	}
 
 	// castling
-	if ((piece_face & KING) && (c1-c2 == 2 || c2-c1 == 2)) {
+	if (flags == KING_CASTLE || flags == QUEEN_CASTLE) {
 		move_notation[k++] = 'O';
 		move_notation[k++] = '-';
 		move_notation[k++] = 'O';
-		if (c1-c2 == 2) { // long castle
+		if (flags == QUEEN_CASTLE) { // long castle
 			move_notation[k++] = '-';
 			move_notation[k++] = 'O';
 		}
@@ -556,38 +677,24 @@ static void find_move_notation (const board_t *board, const short *const dest_ti
 		return;
 	}
 
-	move_notation[k++] = get_piece_for_move_notation(board->tiles[r1][c1].piece);
-	bool other_row = false, other_col = false;
-	for (short nr = 0; nr < 8 && (!other_row || !other_col); nr++) {
-		for (short nc = 0; nc < 8 && (!other_row || !other_col); nc++) {
-			if ((nr == r1 && nc == c1) || board->tiles[nr][nc].piece == NULL || board->tiles[nr][nc].piece->face != piece_face) continue;
-			short new_src[2] = {nr, nc};
-			// pass NULL history as piece won't be pawn so pawn_moves won't be called
-			if (is_reachable(board, &(board->tiles[r2][c2]), &(board->tiles[nr][nc]), NULL) && is_valid_move(*board, dest_tile, new_src)) {
-				if (nr != r1) other_row = true;
-				if (nc != c1) other_col = true;
-			}
-		}
+	move_notation[k++] = get_piece_for_move_notation(piece);
+	// file is enough unless an ambiguous piece shares it, then rank, then both
+	bool ambiguous = false, same_row = false, same_col = false;
+	for (int i = 0; i < list->count; i++) {
+		int other = move_from(list->moves[i]);
+		if (move_to(list->moves[i]) != to || other == from || board->tiles[square_row(other)][square_col(other)].piece.face != piece->face)
+			continue;
+		ambiguous = true;
+		if (square_row(other) == r1) same_row = true;
+		if (square_col(other) == c1) same_col = true;
 	}
-	if (other_col)
+	if (ambiguous && (!same_col || same_row))
 		move_notation[k++] = 'a' + c1;
-	if (other_row)
+	if (same_col)
 		move_notation[k++] = '1' + r1;
-	if (board->tiles[r2][c2].piece != NULL)
+	if (flags & CAPTURE)
 		move_notation[k++] = 'x';
 	move_notation[k++] = 'a' + c2;
 	move_notation[k++] = '1' + r2;
 	move_notation[k++] = '\0';
 }
-
-
-static bool is_reachable (board_t *board, const tile_t *const dest_tile, const tile_t *const src_tile, const history_t *const history) {
-	tile_t **moves = find_moves(board, src_tile, history);
-	if (moves == NULL)
-		return false;
-	bool result = false;
-	for (int k = 0; k < MAX_MOVES && !result && moves[k] != NULL; k++)
-		if (moves[k] == dest_tile) result = true;
-	free(moves);
-	return result;
-}
@@ -4,12 +4,53 @@
 #include "board.h"
 #include "history.h"
 
-#define MAX_MOVES 29	// QUEEN has max moves (7 * 4 = 28) + 1 for NULL senitel
+#define MAX_GAME_MOVES 256	// no legal position has more than 218 moves
 
-tile_t**		find_moves			(board_t *board, const tile_t *tile, const history_t *history);
+/* moves are packed in 16 bits, from square in bits 0-5, to square in bits 6-11 and flags in bits 12-15 */
+#define encode_move(from, to, flags)	((move_t) ((from) | ((to) << 6) | ((flags) << 12)))
+#define move_from(move)					((move) & 63)
+#define move_to(move)					(((move) >> 6) & 63)
+#define move_flags(move)				((move) >> 12)
+#define is_capture(move)				(move_flags(move) & CAPTURE)
+#define is_promotion(move)				(move_flags(move) & PROMOTION)
+// promoted piece face for promotion flags, KNIGHT, BISHOP, ROOK, QUEEN in order
+#define promotion_face(move)			(KNIGHT >> (move_flags(move) & 3))
+#define promotion_flag(face)			(PROMOTION | (4 - piece_index(face)))
+
+#define NULL_MOVE 0
+
+enum	move_flag	{ QUIET_MOVE, DOUBLE_PUSH, KING_CASTLE, QUEEN_CASTLE, CAPTURE, EN_PASSANT, PROMOTION = 8, PROMOTION_CAPTURE = 12 };
+
+typedef	uint16_t	move_t;
+
+typedef struct {
+	move_t moves[MAX_GAME_MOVES];
+	int count;
+} movelist_t;
+
+/* state that make_move can not recompute, enough for unmake_move to restore board exactly */
+typedef struct {
+	piece_t captured;	// face is NO_PIECE if nothing was captured
+	int ep_square;
+	uint8_t castling;
+	uint64_t key;
+	short halfmove_clock;
+	bool is_moved;
+	bool rook_is_moved;
+} undo_t;
+
+
+int				generate_moves		(const board_t *board, movelist_t *list);
+void			make_move			(board_t *board, move_t move, undo_t *undo);
+void			unmake_move			(board_t *board, move_t move, const undo_t *undo);
+void			make_null_move		(board_t *board, undo_t *undo);
+void			unmake_null_move	(board_t *board, const undo_t *undo);
+bool			play_move			(board_t *board, move_t move, history_t *history);
 bool			move_piece			(board_t *board, short *dest_tile, short *src_tile, history_t *history);
 void			clear_dest			(board_t *board);
-void			set_dest			(board_t *board, tile_t ** moves);
+void			set_dest			(board_t *board, const movelist_t *list, int from);
 bool			is_game_finished	(board_t *board, const history_t *history);
+bool			has_legal_move		(const board_t *board);
+bool			in_check			(const board_t *board);
 
 #endif
@@ -0,0 +1,68 @@
+#include "draw.h"
+
+#define LIGHT_SQUARES_BB	0x55AA55AA55AA55AAULL
+
+
+/* history holds the positions before current one, only the last FIFTY_MOVE_PLIES can repeat it. stack is left empty for NULL history */
+void init_key_stack (key_stack_t *stack, const history_t *history) {
+	stack->count = 0;
+	if (history == NULL)
+		return;
+
+	int n = get_size(history);
+
+	// history doesn't keep the initial position games start from
+	if (n < FIFTY_MOVE_PLIES) {
+		board_t initial;
+		init_board(&initial, -1);
+		push_key(stack, initial.key);
+	} else {
+		n = FIFTY_MOVE_PLIES;
+	}
+
+	while (n--)
+		push_key(stack, peek_key(history, n));
+}
+
+
+/* no. of earlier occurrences of board, only positions since last capture or pawn move with same side to move are looked at */
+int count_repetitions (const key_stack_t *stack, const board_t *board) {
+	int oldest = stack->count - board->halfmove_clock;
+	if (oldest < 0)
+		oldest = 0;
+
+	int repetitions = 0;
+	for (int i = stack->count - 2; i >= oldest; i -= 2)
+		if (stack->keys[i] == board->key)
+			repetitions++;
+
+	return repetitions;
+}
+
+
+/* neither side can mate, lone kings with at most one minor piece or only bishops on same colored squares */
+bool is_insufficient_material (const board_t *board) {
+	for (int color = 0; color < 2; color++)
+		if (board->pieces[color][piece_index(PAWN)] | board->pieces[color][piece_index(ROOK)] | board->pieces[color][piece_index(QUEEN)])
+			return false;
+
+	bitboard_t knights = board->pieces[0][piece_index(KNIGHT)] | board->pieces[1][piece_index(KNIGHT)];
+	bitboard_t bishops = board->pieces[0][piece_index(BISHOP)] | board->pieces[1][piece_index(BISHOP)];
+	if (bb_popcount(knights | bishops) <= 1)
+		return true;
+
+	return (knights == EMPTY_BB && ((bishops & LIGHT_SQUARES_BB) == EMPTY_BB || (bishops & ~LIGHT_SQUARES_BB) == EMPTY_BB));
+}
+
+
+/* draw result of board or PENDING, repetitions is no. of earlier occurrences needed, 2 for the game and 1 is enough in search */
+enum result find_draw (const board_t *board, const key_stack_t *stack, int repetitions) {
+	if (board->halfmove_clock >= FIFTY_MOVE_PLIES)
+		return DRAW_BY_FIFTY_MOVES;
+	if (count_repetitions(stack, board) >= repetitions)
+		return DRAW_BY_REPETITION;
+	if (is_insufficient_material(board))
+		return DRAW_BY_MATERIAL;
+
+	return PENDING;
+}
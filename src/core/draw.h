@@ -0,0 +1,27 @@
+#ifndef DRAW_H
+#define DRAW_H
+
+#include <stdint.h>
+
+#include "board.h"
+#include "history.h"
+
+#define MAX_SEARCH_PLIES	128
+#define KEY_STACK_SIZE		(FIFTY_MOVE_PLIES + MAX_SEARCH_PLIES)
+
+/* keys of positions leading to the current one, oldest first, indexed by ply */
+typedef struct {
+	uint64_t keys[KEY_STACK_SIZE];
+	int count;
+} key_stack_t;
+
+#define push_key(stack, key)	((stack)->keys[(stack)->count++] = (key))
+#define pop_key(stack)			((stack)->count--)
+
+
+void		init_key_stack				(key_stack_t *stack, const history_t *history);
+int			count_repetitions			(const key_stack_t *stack, const board_t *board);
+bool		is_insufficient_material	(const board_t *board);
+enum result	find_draw					(const board_t *board, const key_stack_t *stack, int repetitions);
+
+#endif
@@ -7,8 +7,10 @@
 #include "game.h"
 #include "board.h"
 #include "chess_engine.h"
+#include "attack_map.h"
 #include "history.h"
 #include "../ai/ai.h"
+#include "../ai/minimax_ab.h"
 #include "../utils/common.h"
 #include "../utils/file.h"
 #include "chess_clock.h"
@@ -45,8 +47,10 @@ static	void*					refresh_display		(void* args);
 static	void					draw_board			(const board_t *board, const short sel_tile[2], const short cur_tile[2]);
 static	void					draw_tile			(int y, int x, bool is_cur, bool is_sel, bool is_avail);
 static	void					show_history		(history_t *history);
+static	void					show_search_info	(void);
 static	void					show_player_info	(const board_t *board, const player_t plr1, const player_t plr2);
 static	char					get_player_type_char	(const player_t plr);
+static	int						count_threats		(const board_t *board, color_t color);
 static	void					show_menu			(bool is_undo_disabled);
 
 
@@ -78,7 +82,7 @@ enum game_return_code init_game(const game_settings_t game_settings) {
 		if (history == NULL)
 			return INVALID_LOAD;
 		get_players(history, &plr1, &plr2);
-		copy_board(board, peek_board(history, 0));
+		peek_board(history, 0, board);
 		if (board->plr_times[0] != -1)
 			clock = create_chess_clock(board, board->plr_times[0], board->plr_times[1]);
 		// maybe start after first move !?
@@ -86,7 +90,7 @@ enum game_return_code init_game(const game_settings_t game_settings) {
 			start_chess_clock(clock);
 	}
 
-	tile_t	**moves = NULL;
+	movelist_t	moves;
 	int key = -1;
 	onboard = true;
 	short cur_tile[2] = {0, 0};
@@ -189,15 +193,11 @@ enum game_return_code init_game(const game_settings_t game_settings) {
 					clear_dest(board);
 					sel_tile[0] = INVALID_ROW;
 					sel_tile[1] = INVALID_COL;
-					if (moves != NULL) {
-						free(moves);
-						moves = NULL;
-					}
-				} else if (board->tiles[cur_tile[0]][cur_tile[1]].piece != NULL && (board->tiles[cur_tile[0]][cur_tile[1]].piece->face & COLOR_BIT) == board->chance){
+				} else if (!is_empty(&board->tiles[cur_tile[0]][cur_tile[1]]) && (board->tiles[cur_tile[0]][cur_tile[1]].piece.face & COLOR_BIT) == board->chance){
 					sel_tile[0] = cur_tile[0];
 					sel_tile[1] = cur_tile[1];
-					moves = find_moves(board, &board->tiles[sel_tile[0]][sel_tile[1]], history);
-					set_dest(board, moves);
+					generate_moves(board, &moves);
+					set_dest(board, &moves, square_of(sel_tile[0], sel_tile[1]));
 				}
 			} else if ( key == KEY_UP || key == 'k') {
 				if (cur_tile[0] < 7) cur_tile[0]++;
@@ -228,6 +228,7 @@ enum game_return_code init_game(const game_settings_t game_settings) {
 
 	pthread_cancel(display_thread);
 	pthread_join(display_thread, NULL);
+	stop_pondering();
 
 	delete_board(board);
 	delete_history(history);
@@ -258,6 +259,8 @@ static bool _play (board_t *board, history_t *history) {
 
 
 static void undo_game (board_t *board, history_t *history, chess_clock_t *clock) {
+	// AI's search on human's time is for the position being undone
+	stop_pondering();
 	// if clock, pause it first
 	if (clock)
 		pause_chess_clock(clock);
@@ -267,11 +270,8 @@ static void undo_game (board_t *board, history_t *history, chess_clock_t *clock)
 	// extra undo for AI
 	if (players[0].type != HUMAN || players[1].type != HUMAN)
 		undo(history);
-	const board_t *prev_board = peek_board(history, 0);
-	if (prev_board == NULL)
+	if (!peek_board(history, 0, board))
 		init_board(board, get_time_limit(history));
-	else
-		copy_board(board, prev_board);
 	clear_dest(board);
 	// if clock, resume it
 	if (clock)
@@ -311,6 +311,12 @@ static enum game_return_code game_over (board_t *board, history_t * history) {
 		sprintf(result, "%s", "Black Won");
 	else if (board->result == STALE_MATE)
 		sprintf(result, "%s", "Stale Mate");
+	else if (board->result == DRAW_BY_REPETITION)
+		sprintf(result, "%s", "Draw by Repetition");
+	else if (board->result == DRAW_BY_FIFTY_MOVES)
+		sprintf(result, "%s", "Draw by 50 Moves");
+	else if (board->result == DRAW_BY_MATERIAL)
+		sprintf(result, "%s", "Dead Position");
 	// error
 	else
 		exit(EXIT_FAILURE);
@@ -410,6 +416,7 @@ static void* refresh_display (void* args) {
 
 		draw_board(display_data->board, display_data->sel_tile, display_data->cur_tile);
 		show_history(display_data->history);
+		show_search_info();
 		show_player_info(display_data->board, display_data->plr1, display_data->plr2);
 
 // 		bool is_undo_disabled = (display_data->clock ? true: false);
@@ -451,7 +458,7 @@ static void draw_board (const board_t *board, const short sel_tile[2], const sho
 				if ((tile_row + tile_col)%2 != 0) wattron(board_scr, A_STANDOUT);
 
 				wchar_t piece[2] = {0};
-				piece[0] = get_piece_face(board->tiles[tile_row][tile_col].piece);
+				piece[0] = get_piece_face(&board->tiles[tile_row][tile_col].piece);
 				mvwaddwstr(board_scr, i*(tile_size_h + TILE_PAD_h) + tile_size_h/2, j*(tile_size_w + TILE_PAD_w) + tile_size_w/2, piece);
 
 				wattroff(board_scr, A_STANDOUT);
@@ -520,6 +527,20 @@ static void show_history (history_t *history) {
 }
 
 
+/* speed of last AI search, nodes of all its threads, on bottom border of hud */
+static void show_search_info (void) {
+	search_result_t result;
+	if (!get_last_search(&result))
+		return;
+
+	const int SEARCH_INFO_SIZE = 20 + 1;	// "00000 knps 00 thr"
+	char search_info[SEARCH_INFO_SIZE];
+	snprintf(search_info, SEARCH_INFO_SIZE, "%.0f knps %d thr", result.nodes / (result.secs > 0 ? result.secs: 1e-9) / 1000, result.threads);
+	mvwaddnstr(hud_scr, hud_scr_h - 1, 1, search_info, min(SEARCH_INFO_SIZE, hud_scr_w - 2));
+	wrefresh(hud_scr);
+}
+
+
 static void show_player_info (const board_t *board, const player_t plr1, const player_t plr2) {
 	/*
 	 *	FORMAT TO DISPLAY PLAYER INFO
@@ -573,6 +594,22 @@ static void show_player_info (const board_t *board, const player_t plr1, const p
 		mvwaddnstr(plr2_scr, V_OFFSET, H_OFFSET + CAPTURED_SIZE + PLAYER_INFO_SIZE, time_str, TIME_STR_SIZE);
 	}
 
+	// display the threats, CHECK or no. of pieces attacked more times than defended
+	const int THREAT_STR_SIZE = 11 + 1;	// "threats: 00"
+	const int THREAT_OFFSET = H_OFFSET + CAPTURED_SIZE + PLAYER_INFO_SIZE + 6 + 1;	// after the timer
+	char threat_str[THREAT_STR_SIZE];
+	WINDOW *plr_scrs[2] = { plr1_scr, plr2_scr };
+	for (int color = 0; color < 2; color++) {
+		int threats = count_threats(board, color);
+		if (is_check(board, color))
+			snprintf(threat_str, THREAT_STR_SIZE, "CHECK");
+		else if (threats > 0)
+			snprintf(threat_str, THREAT_STR_SIZE, "threats: %d", min(threats, 99));	// a side has at most 16 pieces, clamped for the 2 digits
+		else
+			continue;
+		mvwaddnstr(plr_scrs[color], V_OFFSET, THREAT_OFFSET, threat_str, THREAT_STR_SIZE);
+	}
+
 // 	wrefresh(plr1_scr);
 // 	wrefresh(plr2_scr);
 	wrefresh(plr1_scr);
@@ -600,6 +637,18 @@ static char get_player_type_char (const player_t plr) {
 }
 
 
+static int count_threats (const board_t *board, color_t color) {
+	int threats = 0;
+	bitboard_t pieces = board->occupied[color] & ~board->pieces[color][piece_index(KING)] & board->attacks[!color];
+	while (pieces) {
+		int sq = pop_lsb(&pieces);
+		if (attackers_of(board, sq, !color) > attackers_of(board, sq, color))
+			threats++;
+	}
+	return threats;
+}
+
+
 static void show_menu (bool is_undo_disabled) {
 	werase(menu_scr);
 	box(menu_scr, 0, 0);
@@ -18,13 +18,20 @@ struct history_t {
 	bool is_fake;
 };
 
+/* boards are kept packed, about 90 bytes per move instead of a whole board_t */
 struct board_node_t {
 	board_node_t *prev;
-	board_t *board;
+	packed_board_t position;
+	uint64_t key;	// zobrist key of position, for repetition checks without unpacking
+	uint8_t captured[2][PIECE_TYPES];
+	int plr_times[2];	// in secs, same as board_t
+	short halfmove_clock;
+	uint8_t result;
 	char move_notation[MAX_MOVE_NOTATION_SIZE+1];
 };
 
-static	const board_node_t*		peek	(const history_t *history, int n);
+static	const board_node_t*		peek		(const history_t *history, int n);
+static	void					push_node	(history_t *history, const board_node_t *node);
 
 
 history_t* create_history (const player_t plr1, const player_t plr2, int time_limit) {
@@ -52,17 +59,21 @@ history_t* create_history (const player_t plr1, const player_t plr2, int time_li
 
 
 void add_move (history_t *history, const board_t *board, const char *const move_notation) {
-	board_node_t *board_node = (board_node_t*) malloc(sizeof(board_node_t));
-	memset(board_node, 0, sizeof(board_node_t));
-
-	board_node->prev = history->top;
-	board_node->board = (board_t*) malloc(sizeof(board_t));
-	memset(board_node->board, 0, sizeof(board_t));
-	copy_board(board_node->board, board);
-	strncpy(board_node->move_notation, move_notation, MAX_MOVE_NOTATION_SIZE);
-
-	history->top = board_node;
-	history->size++;
+	board_node_t board_node;
+	memset(&board_node, 0, sizeof(board_node_t));
+
+	pack_board(board, &board_node.position);
+	board_node.key = board->key;
+	board_node.halfmove_clock = board->halfmove_clock;
+	for (int color = 0; color < 2; color++)
+		for (int type = 0; type < PIECE_TYPES; type++)
+			board_node.captured[color][type] = board->captured[color][type];
+	board_node.plr_times[0] = board->plr_times[0];
+	board_node.plr_times[1] = board->plr_times[1];
+	board_node.result = board->result;
+	strncpy(board_node.move_notation, move_notation, MAX_MOVE_NOTATION_SIZE);
+
+	push_node(history, &board_node);
 }
 
 
@@ -72,7 +83,6 @@ void undo (history_t *history) {
 		return;
 
 	history->top = top->prev;
-	delete_board(top->board);
 	free(top);
 	history->size--;
 }
@@ -96,9 +106,35 @@ void delete_history (history_t *history) {
 }
 
 
-const board_t* peek_board (const history_t *history, int n) {
+/* unpack nth last board into board, returns false if history is shorter */
+bool peek_board (const history_t *history, int n, board_t *board) {
+	const board_node_t *curr = peek(history, n);
+	if (curr == NULL)
+		return false;
+
+	memset(board, 0, sizeof(board_t));
+	unpack_board(&curr->position, board);
+	for (int color = 0; color < 2; color++)
+		for (int type = 0; type < PIECE_TYPES; type++)
+			board->captured[color][type] = curr->captured[color][type];
+	board->plr_times[0] = curr->plr_times[0];
+	board->plr_times[1] = curr->plr_times[1];
+	board->halfmove_clock = curr->halfmove_clock;
+	board->result = curr->result;
+
+	return true;
+}
+
+
+const packed_board_t* peek_position (const history_t *history, int n) {
+	const board_node_t *curr = peek(history, n);
+	return (curr != NULL ? &curr->position: NULL);
+}
+
+
+uint64_t peek_key (const history_t *history, int n) {
 	const board_node_t *curr = peek(history, n);
-	return (curr != NULL ? curr->board: NULL);
+	return (curr != NULL ? curr->key: 0);
 }
 
 
@@ -132,7 +168,7 @@ history_t* reverse_history (const history_t *history) {
 	strncpy(reversed_history->timestamp, history->timestamp, TIMESTAMP_SIZE);
 	board_node_t *cur = history->top;
 	while (cur != NULL) {
-		add_move(reversed_history, cur->board, cur->move_notation);
+		push_node(reversed_history, cur);
 		cur = cur->prev;
 	}
 	return reversed_history;
@@ -142,8 +178,19 @@ history_t* reverse_history (const history_t *history) {
 void update_result (history_t *history) {
 	if (history == NULL || get_size(history) == 0)
 		return;
-	is_game_finished(history->top->board, history);
-	history->result = history->top->board->result;
+	board_t board;
+	peek_board(history, 0, &board);
+
+	// is_game_finished expects history before board, take the top off while it looks for repetitions
+	board_node_t *top = history->top;
+	history->top = top->prev;
+	history->size--;
+	is_game_finished(&board, history);
+	history->top = top;
+	history->size++;
+
+	history->top->result = board.result;
+	history->result = board.result;
 }
 
 
@@ -196,3 +243,14 @@ static const board_node_t* peek (const history_t *history, int n) {
 
 	return curr;
 }
+
+
+/* push a copy of node on top of history */
+static void push_node (history_t *history, const board_node_t *node) {
+	board_node_t *board_node = (board_node_t*) malloc(sizeof(board_node_t));
+	memcpy(board_node, node, sizeof(board_node_t));
+
+	board_node->prev = history->top;
+	history->top = board_node;
+	history->size++;
+}
@@ -26,7 +26,9 @@ void				add_move			(history_t *history, const board_t *board, const char *const
 void				undo				(history_t *history);
 void				go_back				(history_t *history, int n);
 void				delete_history		(history_t *history);
-const board_t*		peek_board			(const history_t *history, int n);
+bool				peek_board			(const history_t *history, int n, board_t *board);
+const packed_board_t*	peek_position	(const history_t *history, int n);
+uint64_t			peek_key			(const history_t *history, int n);
 int					get_size			(const history_t *history);
 const char *const	peek_move			(const history_t *history, int n);
 const char *const	get_timestamp		(const history_t *history);
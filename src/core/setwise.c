@@ -0,0 +1,196 @@
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#define HAS_SIMD_FILL	1
+#else
+#define HAS_SIMD_FILL	0
+#endif
+
+#include "setwise.h"
+
+#define NOT_FILE_A	(~FILE_A_BB)
+#define NOT_FILE_H	(~FILE_H_BB)
+#define NOT_FILE_AB	(~(FILE_A_BB | (FILE_A_BB << 1)))
+#define NOT_FILE_GH	(~(FILE_H_BB | (FILE_H_BB >> 1)))
+
+const	char*	FILL_KERNEL_NAMES[FILL_KERNELS]	=	{ "scalar", "sse2", "avx2" };
+
+/*
+ * Kogge-Stone fills run in 4 directions with left shifts (north, east, north east, north west) and the
+ * opposite 4 with right shifts (south, west, south west, south east). Directions 0 and 1 are orthogonal,
+ * 2 and 3 are diagonal. Wrap masks drop the squares a shift carries over from the other edge of the board.
+ */
+static	const	int			SHIFTS[4]		=	{ 8, 1, 9, 7 };
+static	const	bitboard_t	LEFT_WRAPS[4]	=	{ ~EMPTY_BB, NOT_FILE_A, NOT_FILE_A, NOT_FILE_H };
+static	const	bitboard_t	RIGHT_WRAPS[4]	=	{ ~EMPTY_BB, NOT_FILE_H, NOT_FILE_H, NOT_FILE_A };
+
+static	enum fill_kernel	fill_kernel		=	SCALAR_FILL;
+static	void				(*slider_kernel)(const bitboard_t orthogonal[2], const bitboard_t diagonal[2], bitboard_t empty, bitboard_t attacks[2]);
+
+static	void	slider_fill_scalar	(const bitboard_t orthogonal[2], const bitboard_t diagonal[2], bitboard_t empty, bitboard_t attacks[2]);
+#if HAS_SIMD_FILL
+static	void	slider_fill_sse2	(const bitboard_t orthogonal[2], const bitboard_t diagonal[2], bitboard_t empty, bitboard_t attacks[2]);
+static	void	slider_fill_avx2	(const bitboard_t orthogonal[2], const bitboard_t diagonal[2], bitboard_t empty, bitboard_t attacks[2]);
+#endif
+
+
+void init_setwise (void) {
+	if (!set_fill_kernel(AVX2_FILL) && !set_fill_kernel(SSE2_FILL))
+		set_fill_kernel(SCALAR_FILL);
+}
+
+
+/* returns false (and keeps the current kernel) if the kernel isn't supported by this cpu or build */
+bool set_fill_kernel (enum fill_kernel kernel) {
+	switch (kernel) {
+		case SCALAR_FILL:
+			slider_kernel = slider_fill_scalar;
+			break;
+#if HAS_SIMD_FILL
+		case SSE2_FILL:
+			// part of x86-64 baseline
+			slider_kernel = slider_fill_sse2;
+			break;
+		case AVX2_FILL:
+			__builtin_cpu_init();
+			if (!__builtin_cpu_supports("avx2"))
+				return false;
+			slider_kernel = slider_fill_avx2;
+			break;
+#endif
+		default:
+			return false;
+	}
+	fill_kernel = kernel;
+	return true;
+}
+
+
+enum fill_kernel get_fill_kernel (void) {
+	return fill_kernel;
+}
+
+
+/* attacks of all rooks and queens (orthogonal) and bishops and queens (diagonal) of both colors, blockers are included */
+void slider_attacks_setwise (const bitboard_t orthogonal[2], const bitboard_t diagonal[2], bitboard_t empty, bitboard_t attacks[2]) {
+	slider_kernel(orthogonal, diagonal, empty, attacks);
+}
+
+
+bitboard_t pawn_attacks_setwise (bitboard_t pawns, int color) {
+	if (color == 0)
+		return ((pawns << 7) & NOT_FILE_H) | ((pawns << 9) & NOT_FILE_A);
+	return ((pawns >> 9) & NOT_FILE_H) | ((pawns >> 7) & NOT_FILE_A);
+}
+
+
+bitboard_t knight_attacks_setwise (bitboard_t knights) {
+	bitboard_t one = ((knights << 1) & NOT_FILE_A) | ((knights >> 1) & NOT_FILE_H);
+	bitboard_t two = ((knights << 2) & NOT_FILE_AB) | ((knights >> 2) & NOT_FILE_GH);
+	return (one << 16) | (one >> 16) | (two << 8) | (two >> 8);
+}
+
+
+bitboard_t king_attacks_setwise (bitboard_t kings) {
+	bitboard_t attacks = ((kings << 1) & NOT_FILE_A) | ((kings >> 1) & NOT_FILE_H);
+	kings |= attacks;
+	return attacks | (kings << 8) | (kings >> 8);
+}
+
+
+static void slider_fill_scalar (const bitboard_t orthogonal[2], const bitboard_t diagonal[2], bitboard_t empty, bitboard_t attacks[2]) {
+	for (int color = 0; color < 2; color++) {
+		bitboard_t result = EMPTY_BB;
+		for (int d = 0; d < 4; d++) {
+			const bitboard_t sliders = (d < 2 ? orthogonal[color]: diagonal[color]);
+			const int s = SHIFTS[d];
+
+			bitboard_t gen = sliders, pro = empty & LEFT_WRAPS[d];
+			gen |= pro & (gen << s);
+			pro &= pro << s;
+			gen |= pro & (gen << 2*s);
+			pro &= pro << 2*s;
+			gen |= pro & (gen << 4*s);
+			result |= (gen << s) & LEFT_WRAPS[d];
+
+			gen = sliders, pro = empty & RIGHT_WRAPS[d];
+			gen |= pro & (gen >> s);
+			pro &= pro >> s;
+			gen |= pro & (gen >> 2*s);
+			pro &= pro >> 2*s;
+			gen |= pro & (gen >> 4*s);
+			result |= (gen >> s) & RIGHT_WRAPS[d];
+		}
+		attacks[color] = result;
+	}
+}
+
+
+#if HAS_SIMD_FILL
+/* both colors fill in parallel, lane 0 is WHITE and lane 1 is BLACK. SSE2 has no per lane shift counts, so lanes share a direction */
+static void slider_fill_sse2 (const bitboard_t orthogonal[2], const bitboard_t diagonal[2], bitboard_t empty, bitboard_t attacks[2]) {
+	const __m128i orth = _mm_set_epi64x(orthogonal[1], orthogonal[0]);
+	const __m128i diag = _mm_set_epi64x(diagonal[1], diagonal[0]);
+	__m128i result = _mm_setzero_si128();
+
+	for (int d = 0; d < 4; d++) {
+		const __m128i sliders = (d < 2 ? orth: diag);
+		const __m128i s1 = _mm_cvtsi32_si128(SHIFTS[d]), s2 = _mm_cvtsi32_si128(2*SHIFTS[d]), s4 = _mm_cvtsi32_si128(4*SHIFTS[d]);
+
+		__m128i wrap = _mm_set1_epi64x(LEFT_WRAPS[d]);
+		__m128i gen = sliders, pro = _mm_and_si128(_mm_set1_epi64x(empty), wrap);
+		gen = _mm_or_si128(gen, _mm_and_si128(pro, _mm_sll_epi64(gen, s1)));
+		pro = _mm_and_si128(pro, _mm_sll_epi64(pro, s1));
+		gen = _mm_or_si128(gen, _mm_and_si128(pro, _mm_sll_epi64(gen, s2)));
+		pro = _mm_and_si128(pro, _mm_sll_epi64(pro, s2));
+		gen = _mm_or_si128(gen, _mm_and_si128(pro, _mm_sll_epi64(gen, s4)));
+		result = _mm_or_si128(result, _mm_and_si128(_mm_sll_epi64(gen, s1), wrap));
+
+		wrap = _mm_set1_epi64x(RIGHT_WRAPS[d]);
+		gen = sliders, pro = _mm_and_si128(_mm_set1_epi64x(empty), wrap);
+		gen = _mm_or_si128(gen, _mm_and_si128(pro, _mm_srl_epi64(gen, s1)));
+		pro = _mm_and_si128(pro, _mm_srl_epi64(pro, s1));
+		gen = _mm_or_si128(gen, _mm_and_si128(pro, _mm_srl_epi64(gen, s2)));
+		pro = _mm_and_si128(pro, _mm_srl_epi64(pro, s2));
+		gen = _mm_or_si128(gen, _mm_and_si128(pro, _mm_srl_epi64(gen, s4)));
+		result = _mm_or_si128(result, _mm_and_si128(_mm_srl_epi64(gen, s1), wrap));
+	}
+
+	_mm_storeu_si128((__m128i *) attacks, result);
+}
+
+
+/* all four directions of one shift sign fill in parallel, one lane per direction */
+__attribute__((target("avx2")))
+static void slider_fill_avx2 (const bitboard_t orthogonal[2], const bitboard_t diagonal[2], bitboard_t empty, bitboard_t attacks[2]) {
+	const __m256i s1 = _mm256_set_epi64x(SHIFTS[3], SHIFTS[2], SHIFTS[1], SHIFTS[0]);
+	const __m256i s2 = _mm256_add_epi64(s1, s1);
+	const __m256i s4 = _mm256_add_epi64(s2, s2);
+	const __m256i left_wrap = _mm256_set_epi64x(LEFT_WRAPS[3], LEFT_WRAPS[2], LEFT_WRAPS[1], LEFT_WRAPS[0]);
+	const __m256i right_wrap = _mm256_set_epi64x(RIGHT_WRAPS[3], RIGHT_WRAPS[2], RIGHT_WRAPS[1], RIGHT_WRAPS[0]);
+	const __m256i empty_vec = _mm256_set1_epi64x(empty);
+
+	for (int color = 0; color < 2; color++) {
+		const __m256i sliders = _mm256_set_epi64x(diagonal[color], diagonal[color], orthogonal[color], orthogonal[color]);
+
+		__m256i gen = sliders, pro = _mm256_and_si256(empty_vec, left_wrap);
+		gen = _mm256_or_si256(gen, _mm256_and_si256(pro, _mm256_sllv_epi64(gen, s1)));
+		pro = _mm256_and_si256(pro, _mm256_sllv_epi64(pro, s1));
+		gen = _mm256_or_si256(gen, _mm256_and_si256(pro, _mm256_sllv_epi64(gen, s2)));
+		pro = _mm256_and_si256(pro, _mm256_sllv_epi64(pro, s2));
+		gen = _mm256_or_si256(gen, _mm256_and_si256(pro, _mm256_sllv_epi64(gen, s4)));
+		__m256i result = _mm256_and_si256(_mm256_sllv_epi64(gen, s1), left_wrap);
+
+		gen = sliders, pro = _mm256_and_si256(empty_vec, right_wrap);
+		gen = _mm256_or_si256(gen, _mm256_and_si256(pro, _mm256_srlv_epi64(gen, s1)));
+		pro = _mm256_and_si256(pro, _mm256_srlv_epi64(pro, s1));
+		gen = _mm256_or_si256(gen, _mm256_and_si256(pro, _mm256_srlv_epi64(gen, s2)));
+		pro = _mm256_and_si256(pro, _mm256_srlv_epi64(pro, s2));
+		gen = _mm256_or_si256(gen, _mm256_and_si256(pro, _mm256_srlv_epi64(gen, s4)));
+		result = _mm256_or_si256(result, _mm256_and_si256(_mm256_srlv_epi64(gen, s1), right_wrap));
+
+		// or the four lanes together
+		__m128i half = _mm_or_si128(_mm256_castsi256_si128(result), _mm256_extracti128_si256(result, 1));
+		attacks[color] = _mm_cvtsi128_si64(half) | _mm_cvtsi128_si64(_mm_unpackhi_epi64(half, half));
+	}
+}
+#endif
@@ -0,0 +1,20 @@
+#ifndef SETWISE_H
+#define SETWISE_H
+
+#include "bitboard.h"
+
+/* set-wise attack generation, every function takes a whole set of pieces instead of one square */
+enum	fill_kernel	{ SCALAR_FILL, SSE2_FILL, AVX2_FILL, FILL_KERNELS };
+
+extern	const	char*	FILL_KERNEL_NAMES[FILL_KERNELS];
+
+
+void			init_setwise				(void);
+bool			set_fill_kernel				(enum fill_kernel kernel);
+enum fill_kernel	get_fill_kernel			(void);
+void			slider_attacks_setwise		(const bitboard_t orthogonal[2], const bitboard_t diagonal[2], bitboard_t empty, bitboard_t attacks[2]);
+bitboard_t		pawn_attacks_setwise		(bitboard_t pawns, int color);
+bitboard_t		knight_attacks_setwise		(bitboard_t knights);
+bitboard_t		king_attacks_setwise		(bitboard_t kings);
+
+#endif
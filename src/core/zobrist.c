@@ -0,0 +1,69 @@
+#include "zobrist.h"
+
+uint64_t	ZOBRIST_PIECES[2][PIECE_TYPES][64];
+uint64_t	ZOBRIST_CHANCE;
+uint64_t	ZOBRIST_CASTLING[16];
+uint64_t	ZOBRIST_EP[8];
+
+
+static	uint64_t	random_key	(void);
+
+
+void init_zobrist (void) {
+	static bool initialized = false;
+	if (initialized)
+		return;
+
+	for (int color = 0; color < 2; color++)
+		for (int type = 0; type < PIECE_TYPES; type++)
+			for (int sq = 0; sq < 64; sq++)
+				ZOBRIST_PIECES[color][type][sq] = random_key();
+
+	ZOBRIST_CHANCE = random_key();
+
+	// combined rights get xor of their single right keys so that updating one right at a time is also possible
+	uint64_t rights_keys[4];
+	for (int i = 0; i < 4; i++)
+		rights_keys[i] = random_key();
+	for (int rights = 0; rights < 16; rights++) {
+		ZOBRIST_CASTLING[rights] = 0;
+		for (int i = 0; i < 4; i++)
+			if (rights & (1 << i))
+				ZOBRIST_CASTLING[rights] ^= rights_keys[i];
+	}
+
+	for (int col = 0; col < 8; col++)
+		ZOBRIST_EP[col] = random_key();
+
+	initialized = true;
+}
+
+
+/* key from scratch, make_move and move_piece keep it updated incrementally afterwards */
+uint64_t compute_key (const board_t *board) {
+	uint64_t key = 0;
+	for (int color = 0; color < 2; color++) {
+		for (int type = 0; type < PIECE_TYPES; type++) {
+			bitboard_t pieces = board->pieces[color][type];
+			while (pieces)
+				key ^= ZOBRIST_PIECES[color][type][pop_lsb(&pieces)];
+		}
+	}
+
+	if (board->chance & BLACK)
+		key ^= ZOBRIST_CHANCE;
+	key ^= castling_key(board->castling);
+	key ^= ep_key(board->ep_square);
+
+	return key;
+}
+
+
+/* xorshift64*, fixed seed so that keys (and any stored key) stay the same across runs */
+static uint64_t random_key (void) {
+	static uint64_t state = 0x9E3779B97F4A7C15ULL;
+	state ^= state >> 12;
+	state ^= state << 25;
+	state ^= state >> 27;
+	return state * 2685821657736338717ULL;
+}
@@ -0,0 +1,21 @@
+#ifndef ZOBRIST_H
+#define ZOBRIST_H
+
+#include <stdint.h>
+
+#include "board.h"
+
+#define piece_key(face, sq)		(ZOBRIST_PIECES[color_index(face)][piece_index(face)][sq])
+#define castling_key(rights)	(ZOBRIST_CASTLING[rights])
+#define ep_key(sq)				((sq) == NO_SQUARE ? 0: ZOBRIST_EP[square_col(sq)])
+
+extern	uint64_t	ZOBRIST_PIECES[2][PIECE_TYPES][64];	// indexed by color, piece_index and square
+extern	uint64_t	ZOBRIST_CHANCE;						// black to move
+extern	uint64_t	ZOBRIST_CASTLING[16];				// indexed by castling rights mask
+extern	uint64_t	ZOBRIST_EP[8];						// indexed by column of en passant square
+
+
+void		init_zobrist	(void);
+uint64_t	compute_key		(const board_t *board);
+
+#endif
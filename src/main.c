@@ -7,6 +7,14 @@
 #include "config.h"
 #include "menus/main_menu.h"
 #include "utils/file.h"
+#include "core/bitboard.h"
+#include "core/zobrist.h"
+#include "cli/bench.h"
+#include "cli/perft.h"
+#include "cli/search.h"
+#include "cli/notation.h"
+#include "ai/tt.h"
+#include "ai/minimax_ab.h"
 
 
 char	*save_directory		=	NULL;
@@ -16,6 +24,30 @@ int		pgn_directory_size	=	0;
 
 
 int main (int argc, char **argv) {
+	// headless modes, don't need HOME or ncurses
+	if (argc > 1 && strcmp(argv[1], "bench") == 0)
+		return run_bench();
+	if (argc > 1 && (strcmp(argv[1], "perft") == 0 || strcmp(argv[1], "divide") == 0))
+		return run_perft(argc, argv);
+	if (argc > 1 && strcmp(argv[1], "search") == 0)
+		return run_search(argc, argv);
+	if (argc > 1 && strcmp(argv[1], "notation") == 0)
+		return run_notation();
+
+	// chess-cli [-H hash_mb] [-t threads], size of AI's transposition table and no. of threads it searches with
+	long hash_mb = DEFAULT_TT_MB, threads = 1;
+	for (int i = 1; i < argc; i += 2) {
+		if (strcmp(argv[i], "-H") == 0 && i+1 < argc && atol(argv[i+1]) >= 0) {
+			hash_mb = atol(argv[i+1]);
+		} else if (strcmp(argv[i], "-t") == 0 && i+1 < argc && atol(argv[i+1]) >= 1) {
+			threads = atol(argv[i+1]);
+		} else {
+			fprintf(stderr, "usage: chess-cli [-H hash_mb] [-t threads] | bench | perft | divide | search | notation\n");
+			exit(EXIT_FAILURE);
+		}
+	}
+	set_search_threads(threads);
+
 	// set save_directory and save_directory_size
 	char *home_dir = getenv("HOME");
 	if (home_dir == NULL) {
@@ -42,6 +74,14 @@ int main (int argc, char **argv) {
 	snprintf(pgn_directory, pgn_directory_size, "%s/%s/%s/", home_dir, BASE_DIR, PGN_DIR);
 
 
+	// precompute attack tables and hash keys used by chess engine
+	init_bitboards();
+	init_zobrist();
+	if (hash_mb > 0 && !init_tt(hash_mb)) {
+		fprintf(stderr, "couldn't allocate memory for transposition table\n");
+		exit(EXIT_FAILURE);
+	}
+
 	setlocale(LC_ALL, "");	// support printing of UNICODE chars
 	initscr();
 	noecho();
@@ -5,6 +5,7 @@
 #include "file.h"
 #include "common.h"
 #include "../core/history.h"
+#include "../core/zobrist.h"
 #include "../config.h"
 #include "../menus/load_menu.h"	// for show_warning_scr
 
@@ -15,6 +16,8 @@ static	const char	PIECE_MOVED		=	'X';
 static	const char	PIECE_NOT_MOVED	=	'O';
 
 static	void		write_to_file	(FILE *fp, const char buffer[], const unsigned int ptr);
+static	int			find_ep_square	(const board_t *prev_board, const board_t *board);
+static	short		find_halfmove_clock	(const board_t *prev_board, const board_t *board);
 
 
 bool save_hstk (const history_t *history) {
@@ -100,7 +103,9 @@ bool save_hstk (const history_t *history) {
 		// LVL2_DELIMITER
 		buffer[ptr++] = LVL2_DELIMITER;
 		
-		const board_t *board = peek_board(reversed_history, 0);
+		board_t board_data;
+		const board_t *board = &board_data;
+		peek_board(reversed_history, 0, &board_data);
 		// store #captured pieces data
 		for (int j = 0; j < 2 ; j++) {
 			for (int k = 0; k < PIECE_TYPES; k++) {
@@ -117,8 +122,8 @@ bool save_hstk (const history_t *history) {
 		int empty_cells_count = 0;
 		for (int j = 0; j < 8; j++) {
 			for (int k = 0; k < 8; k++) {
-				const piece_t *piece = board->tiles[j][k].piece;
-				if (piece == NULL) {
+				const piece_t *piece = &board->tiles[j][k].piece;
+				if (piece->face == NO_PIECE) {
 					empty_cells_count++;
 					continue;
 				}
@@ -252,7 +257,7 @@ history_t* load_hstk (const timestamp_t timestamp) {
 	set_timestamp(history, timestamp);
 
 	board_t *board = NULL;
-	piece_t *piece = NULL;
+	piece_t piece = EMPTY_PIECE;	// parsed piece waiting for its moved flag
 	while (!error) {
 		char move_notation[MAX_MOVE_NOTATION_SIZE+1];
 		memset(move_notation, 0, MAX_MOVE_NOTATION_SIZE+1);
@@ -291,11 +296,11 @@ history_t* load_hstk (const timestamp_t timestamp) {
 		}
 		// board->tiles
 		short row = 0, col = 0;
-		piece = NULL;
+		piece.face = NO_PIECE;
 		unsigned int empty_cells_count = 0;
 		while ((c = getc(fp)) != LVL2_DELIMITER && !error) {
 			if (c >= '0' && c <= '9') {
-				if (piece != NULL) {
+				if (piece.face != NO_PIECE) {
 					error = true;
 					break;
 				}
@@ -324,17 +329,14 @@ history_t* load_hstk (const timestamp_t timestamp) {
 			for (int i = 0; i < 2 && !is_piece; i++) {
 				for (int j = 0; j < PIECE_TYPES && !is_piece; j++) {
 					if (c == PIECES[0][i][j]) {
-						piece = (piece_t *) calloc(1, sizeof(piece_t));
-						if (i != WHITE) piece->face |= BLACK;
-						piece->face |= (1 << j);
+						piece.face = (1 << j);
+						if (i != WHITE) piece.face |= BLACK;
 						is_piece = true;
 						
 						if (row > 7 || col > 7) {
 							error = true;
 							break;
 						}
-						if ((1 << j) & KING)
-							board->kings[i] = &(board->tiles[row][col]);
 					}
 				}
 			}
@@ -343,13 +345,13 @@ history_t* load_hstk (const timestamp_t timestamp) {
 			}
 
 			if (c == PIECE_MOVED || c == PIECE_NOT_MOVED) {
-				if (piece == NULL || row > 7 || col > 7) {
+				if (piece.face == NO_PIECE || row > 7 || col > 7) {
 					error = true;
 					break;
 				}
-				piece->is_moved = (c == PIECE_MOVED ? true: false);
+				piece.is_moved = (c == PIECE_MOVED ? true: false);
 				board->tiles[row][col].piece = piece;
-				piece = NULL;
+				piece.face = NO_PIECE;
 				board->tiles[row][col].row = row;
 				board->tiles[row][col].col = col;
 
@@ -416,6 +418,15 @@ history_t* load_hstk (const timestamp_t timestamp) {
 		if (error)
 			break;
 
+		sync_bitboards(board);
+		board->castling = find_castling_rights(board);
+		// first saved board follows the initial one, which history doesn't keep
+		board_t prev_board;
+		if (!peek_board(history, 0, &prev_board))
+			init_board(&prev_board, board->plr_times[0]);
+		board->ep_square = find_ep_square(&prev_board, board);
+		board->halfmove_clock = find_halfmove_clock(&prev_board, board);
+		board->key = compute_key(board);
 		add_move(history, board, move_notation);
 		delete_board(board);
 		board = NULL;
@@ -425,7 +436,6 @@ history_t* load_hstk (const timestamp_t timestamp) {
 	fclose(fp);
 	if (error) {
 		if (board) free(board);
-		if (piece) free(piece);
 		fprintf(stderr, "error while loading file... INVALID SAVE FILE");
 		delete_history(history);
 		return NULL;
@@ -454,7 +464,7 @@ bool export_pgn (const history_t *history) {
  *	RESULT		-	"*"			(PENDING)
  *				-	"1-0"		(WHITE_WON)
  *				-	"0-1"		(BLACK_WON)
- *					"1/2-1/2"	(STALE_MATE / DRAW)
+ *				-	"1/2-1/2"	(STALE_MATE / DRAW_BY_REPETITION / DRAW_BY_FIFTY_MOVES / DRAW_BY_MATERIAL)
  */
 
 	if (history == NULL || get_size(history) == 0)
@@ -528,6 +538,10 @@ bool export_pgn (const history_t *history) {
 		case BLACK_WON:
 			snprintf(result_pgn_format, MAX_RESULT_SIZE, "0-1");
 			break;
+		case STALE_MATE:
+		case DRAW_BY_REPETITION:
+		case DRAW_BY_FIFTY_MOVES:
+		case DRAW_BY_MATERIAL:
 		default:
 			snprintf(result_pgn_format, MAX_RESULT_SIZE, "1/2-1/2");
 	}
@@ -602,3 +616,31 @@ static void write_to_file (FILE *fp, const char buffer[], const unsigned int ptr
 		exit(EXIT_FAILURE);
 	}
 }
+
+
+/* save file doesn't store en passant square, recover it from a pawn that made double step between the two boards */
+static int find_ep_square (const board_t *prev_board, const board_t *board) {
+	color_t color = (board->chance & BLACK ? 0: 1);	// color that made the last move
+	int forward = (color ? -8: 8);
+	bitboard_t prev_pawns = prev_board->pieces[color][piece_index(PAWN)], pawns = board->pieces[color][piece_index(PAWN)];
+	bitboard_t left = prev_pawns & ~pawns & row_bb(color ? 6: 1);
+	bitboard_t arrived = pawns & ~prev_pawns & row_bb(color ? 4: 3);
+
+	if (bb_popcount(left) != 1 || arrived != square_bb(bb_lsb(left) + 2*forward))
+		return NO_SQUARE;
+
+	// kept only if an enemy pawn can capture, same as chess_engine.c:make_move
+	int passed = bb_lsb(left) + forward;
+	if (!(PAWN_ATTACKS[color][passed] & board->pieces[!color][piece_index(PAWN)]))
+		return NO_SQUARE;
+	return passed;
+}
+
+
+/* save file doesn't store halfmove clock either, it restarts when last move was a capture or moved a pawn */
+static short find_halfmove_clock (const board_t *prev_board, const board_t *board) {
+	color_t color = (board->chance & BLACK ? 0: 1);	// color that made the last move
+	if (prev_board->pieces[color][piece_index(PAWN)] != board->pieces[color][piece_index(PAWN)] || prev_board->occupied[!color] != board->occupied[!color])
+		return 0;
+	return prev_board->halfmove_clock + 1;
+}
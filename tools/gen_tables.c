@@ -0,0 +1,187 @@
+/*
+ * Generator of the constant attack and geometry tables, run by the Makefile:
+ *
+ *	gen_tables > gen/tables.c
+ *
+ * Tables only depend on board geometry, emitting them as const data leaves nothing to compute when the engine starts.
+ * Magic multipliers are searched here as well, the slider attack tables they index are still filled by init_bitboards.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../src/core/bitboard.h"
+
+static	const	short	KING_OFFSETS[8][2]		=	{ {-1, -1}, {-1, 0}, {-1, 1}, {0, -1}, {0, 1}, {1, -1}, {1, 0}, {1, 1} };
+static	const	short	KNIGHT_OFFSETS[8][2]	=	{ {-2, -1}, {-2, 1}, {-1, -2}, {-1, 2}, {1, -2}, {1, 2}, {2, -1}, {2, 1} };
+static	const	short	WHITE_PAWN_OFFSETS[2][2]	=	{ {1, -1}, {1, 1} };
+static	const	short	BLACK_PAWN_OFFSETS[2][2]	=	{ {-1, -1}, {-1, 1} };
+// rays only serve to build BETWEEN and LINE, opposite directions differ only in the lowest bit
+enum	direction	{ NORTH, SOUTH, EAST, WEST, NORTH_EAST, SOUTH_WEST, NORTH_WEST, SOUTH_EAST, DIRECTIONS };
+// in same order as enum direction
+static	const	short	DIRECTION_STEPS[DIRECTIONS][2]	=	{ {1, 0}, {-1, 0}, {0, 1}, {0, -1}, {1, 1}, {-1, -1}, {1, -1}, {-1, 1} };
+static	const	short	ROOK_DIRECTIONS[4][2]	=	{ {-1, 0}, {1, 0}, {0, -1}, {0, 1} };
+static	const	short	BISHOP_DIRECTIONS[4][2]	=	{ {-1, -1}, {1, 1}, {-1, 1}, {1, -1} };
+
+static	bitboard_t	king_attacks[64], knight_attacks[64], pawn_attacks[2][64];
+static	bitboard_t	rays[DIRECTIONS][64], between[64][64], line[64][64];
+static	bitboard_t	rook_magics[64], bishop_magics[64];
+
+static	bitboard_t	offsets_bb		(int sq, const short offsets[][2], int n);
+static	bitboard_t	slider_walk		(int sq, bitboard_t occupied, const short directions[4][2]);
+static	void		find_magics		(bitboard_t magics[64], const short directions[4][2]);
+static	bitboard_t	find_magic		(bitboard_t mask, int bits, const bitboard_t *occupancies, const bitboard_t *attacks, int size);
+static	bitboard_t	random_bb		(void);
+static	void		print_table		(const char *declaration, const bitboard_t *table, int rows, int cols);
+
+
+int main (void) {
+	for (int sq = 0; sq < 64; sq++) {
+		king_attacks[sq] = offsets_bb(sq, KING_OFFSETS, 8);
+		knight_attacks[sq] = offsets_bb(sq, KNIGHT_OFFSETS, 8);
+		pawn_attacks[0][sq] = offsets_bb(sq, WHITE_PAWN_OFFSETS, 2);
+		pawn_attacks[1][sq] = offsets_bb(sq, BLACK_PAWN_OFFSETS, 2);
+	}
+
+	for (int dir = 0; dir < DIRECTIONS; dir++) {
+		for (int sq = 0; sq < 64; sq++) {
+			short step_row = DIRECTION_STEPS[dir][0], step_col = DIRECTION_STEPS[dir][1];
+			for (short i = square_row(sq) + step_row, j = square_col(sq) + step_col; i >= 0 && i < 8 && j >= 0 && j < 8; i += step_row, j += step_col)
+				rays[dir][sq] |= square_bb(square_of(i, j));
+		}
+	}
+
+	// a and b share a line if b is on a ray from a, opposite ray from b meets it on the squares between
+	for (int a = 0; a < 64; a++) {
+		for (int b = 0; b < 64; b++) {
+			for (int dir = 0; dir < DIRECTIONS; dir++) {
+				if (!(rays[dir][a] & square_bb(b)))
+					continue;
+				int opposite = dir ^ 1;
+				between[a][b] = rays[dir][a] & rays[opposite][b];
+				line[a][b] = rays[dir][a] | rays[opposite][a] | square_bb(a);
+			}
+		}
+	}
+
+	find_magics(rook_magics, ROOK_DIRECTIONS);
+	find_magics(bishop_magics, BISHOP_DIRECTIONS);
+
+	printf("/* generated by tools/gen_tables.c, do not edit */\n");
+	printf("#include \"../src/core/bitboard.h\"\n\n");
+	print_table("const bitboard_t KING_ATTACKS[64]", king_attacks, 1, 64);
+	print_table("const bitboard_t KNIGHT_ATTACKS[64]", knight_attacks, 1, 64);
+	print_table("const bitboard_t PAWN_ATTACKS[2][64]", &pawn_attacks[0][0], 2, 64);
+	print_table("const bitboard_t BETWEEN[64][64]", &between[0][0], 64, 64);
+	print_table("const bitboard_t LINE[64][64]", &line[0][0], 64, 64);
+	print_table("const bitboard_t ROOK_MAGICS[64]", rook_magics, 1, 64);
+	print_table("const bitboard_t BISHOP_MAGICS[64]", bishop_magics, 1, 64);
+
+	return EXIT_SUCCESS;
+}
+
+
+static bitboard_t offsets_bb (int sq, const short offsets[][2], int n) {
+	bitboard_t bb = EMPTY_BB;
+	short row = square_row(sq), col = square_col(sq);
+	for (int k = 0; k < n; k++) {
+		short i = row + offsets[k][0], j = col + offsets[k][1];
+		// out of board
+		if (i < 0 || i > 7 || j < 0 || j > 7)
+			continue;
+		bb |= square_bb(square_of(i, j));
+	}
+	return bb;
+}
+
+
+static bitboard_t slider_walk (int sq, bitboard_t occupied, const short directions[4][2]) {
+	bitboard_t bb = EMPTY_BB;
+	short row = square_row(sq), col = square_col(sq);
+	for (int k = 0; k < 4; k++) {
+		for (short i = row + directions[k][0], j = col + directions[k][1]; i >= 0 && i < 8 && j >= 0 && j < 8; i += directions[k][0], j += directions[k][1]) {
+			bb |= square_bb(square_of(i, j));
+			if (occupied & square_bb(square_of(i, j)))
+				break;
+		}
+	}
+	return bb;
+}
+
+
+/* relevant occupancy masks must match the ones bitboard.c:init_slider_entries builds */
+static void find_magics (bitboard_t magics[64], const short directions[4][2]) {
+	static bitboard_t occupancies[4096], attacks[4096];
+
+	for (int sq = 0; sq < 64; sq++) {
+		// edge squares don't change the attack set unless the slider is on that edge
+		bitboard_t edges = ((ROW_1_BB | ROW_8_BB) & ~row_bb(square_row(sq))) | ((FILE_A_BB | FILE_H_BB) & ~col_bb(square_col(sq)));
+		bitboard_t mask = slider_walk(sq, EMPTY_BB, directions) & ~edges;
+		int size = 0;
+
+		// enumerate all subsets of mask (carry-rippler)
+		bitboard_t subset = EMPTY_BB;
+		do {
+			occupancies[size] = subset;
+			attacks[size] = slider_walk(sq, subset, directions);
+			size++;
+			subset = (subset - mask) & mask;
+		} while (subset);
+
+		magics[sq] = find_magic(mask, bb_popcount(mask), occupancies, attacks, size);
+	}
+}
+
+
+/* trial and error search of a magic multiplier mapping every occupancy to an index without destructive collisions */
+static bitboard_t find_magic (bitboard_t mask, int bits, const bitboard_t *occupancies, const bitboard_t *attacks, int size) {
+	static bitboard_t used[4096];
+	static int epoch[4096];
+	static int tries = 0;
+
+	while (true) {
+		bitboard_t magic = random_bb() & random_bb() & random_bb();
+		// magics mapping too few mask bits into the top byte rarely work
+		if (bb_popcount((mask * magic) & 0xFF00000000000000ULL) < 6)
+			continue;
+
+		tries++;
+		bool is_magic = true;
+		for (int k = 0; k < size && is_magic; k++) {
+			int idx = (occupancies[k] * magic) >> (64 - bits);
+			if (epoch[idx] != tries) {
+				epoch[idx] = tries;
+				used[idx] = attacks[k];
+			} else if (used[idx] != attacks[k]) {
+				is_magic = false;
+			}
+		}
+		if (is_magic)
+			return magic;
+	}
+}
+
+
+/* xorshift64*, fixed seed so that the same magics are found on every run */
+static bitboard_t random_bb (void) {
+	static bitboard_t state = 1070372ULL;
+	state ^= state >> 12;
+	state ^= state << 25;
+	state ^= state >> 27;
+	return state * 2685821657736338717ULL;
+}
+
+
+/* rows of a two dimensional table get their own braces, one dimensional tables have a single row */
+static void print_table (const char *declaration, const bitboard_t *table, int rows, int cols) {
+	const char *indent = (rows > 1 ? "\t\t": "\t");
+	printf("%s = {\n", declaration);
+	for (int i = 0; i < rows; i++) {
+		if (rows > 1)
+			printf("\t{\n");
+		for (int j = 0; j < cols; j++)
+			printf("%s0x%016llXULL,%s", (j % 4 == 0 ? indent: " "), (unsigned long long) table[i * cols + j], (j % 4 == 3 || j == cols-1 ? "\n": ""));
+		if (rows > 1)
+			printf("\t},\n");
+	}
+	printf("};\n\n");
+}